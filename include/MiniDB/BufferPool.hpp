@@ -0,0 +1,148 @@
+#pragma once
+
+#include "ColumnPage.hpp"
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include <sys/types.h>
+
+using PageId = uint64_t;
+
+// Presupuesto de memoria por defecto del buffer pool
+constexpr size_t DEFAULT_BUFFER_POOL_BYTES = 256 * 1024 * 1024;
+
+struct BufferPoolStats {
+    size_t budget = 0;
+    size_t residentBytes = 0;
+    size_t residentPages = 0;
+    size_t totalPages = 0;
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    uint64_t evictions = 0;
+    uint64_t writeBacks = 0;
+    uint64_t prefetches = 0;
+    uint64_t spillErrors = 0; // Escrituras fallidas en el archivo de intercambio
+};
+
+class BufferPool;
+
+// Mantiene una página fijada (pinned) en memoria mientras existe.
+// Si se modifican sus filas hay que llamar a markDirty().
+class PageHandle
+{
+public:
+    PageHandle() = default;
+    PageHandle(BufferPool* pool, PageId id, ColumnPage* page);
+    PageHandle(PageHandle&& other) noexcept;
+    PageHandle& operator=(PageHandle&& other) noexcept;
+    PageHandle(const PageHandle&) = delete;
+    PageHandle& operator=(const PageHandle&) = delete;
+    ~PageHandle();
+
+    ColumnPage& page() const;
+    void markDirty();
+
+private:
+    void release();
+
+    BufferPool* pool = nullptr;
+    PageId pageId = 0;
+    ColumnPage* data = nullptr;
+    bool dirty = false;
+};
+
+// Administra las páginas de filas de todas las tablas con un presupuesto de
+// memoria. Las páginas no fijadas se desalojan con el algoritmo del reloj
+// (clock) y, si están sucias, se escriben antes en un archivo de intercambio.
+// Las lecturas y escrituras del archivo se hacen sin tomar 'mutex': mientras
+// tanto la página queda marcada (cargando o escribiéndose) y quien la necesite
+// espera solo por ella.
+class BufferPool
+{
+public:
+    BufferPool(size_t memoryBudget, std::string spillPath);
+    ~BufferPool();
+
+    BufferPool(const BufferPool&) = delete;
+    BufferPool& operator=(const BufferPool&) = delete;
+
+    // Crea una página (vacía o con el contenido dado) y devuelve su identificador
+    PageId allocate(ColumnPage page = ColumnPage());
+    // Fija la página en memoria, leyéndola del disco si fue desalojada.
+    // Lanza std::runtime_error si su copia en disco no se puede leer.
+    PageHandle pin(PageId id);
+    // Read-ahead: pide cargar la página en segundo plano sin fijarla
+    void prefetch(PageId id);
+    // Libera la página y su espacio en disco
+    void free(PageId id);
+
+    void setBudget(size_t bytes);
+    BufferPoolStats getStats() const;
+    // Error de escritura no informado aún (y lo descarta); una serie de fallos
+    // seguidos se informa una sola vez. Una página que no se pudo escribir
+    // sigue en memoria, aunque se supere el presupuesto.
+    std::optional<std::string> takeError();
+
+private:
+    friend class PageHandle;
+
+    struct Frame {
+        ColumnPage page;
+        size_t pinCount = 0;
+        size_t bytes = 0;
+        bool dirty = false;
+        bool referenced = true; // Bit de referencia del reloj
+        bool loading = false;   // Se está leyendo del disco; 'page' aún no es válida
+    };
+
+    // Copia de una página en el archivo de intercambio
+    struct DiskSlot {
+        off_t offset = 0;
+        size_t capacity = 0; // Bytes reservados en el archivo
+        size_t size = 0;     // Bytes de la última versión escrita
+    };
+
+    void unpin(PageId id, bool dirty);
+    // Los métodos siguientes se llaman con 'lock' (sobre 'mutex') tomado y lo
+    // sueltan durante la E/S del archivo de intercambio
+    Frame& load(std::unique_lock<std::mutex>& lock, PageId id, bool prefetching = false);
+    void evictIfNeeded(std::unique_lock<std::mutex>& lock);
+    bool writeBack(std::unique_lock<std::mutex>& lock, PageId id);
+    // Requiere 'mutex'. false si el archivo no se pudo abrir
+    bool openSpill();
+    bool fail(const std::string& message);
+    bool isBusy(PageId id) const;
+    void readAheadLoop();
+
+    mutable std::mutex mutex;
+    std::condition_variable frameCv; // Avisa cuando termina una carga o escritura
+    std::condition_variable readAheadCv;
+    std::deque<PageId> readAheadQueue;
+    bool stopping = false;
+
+    std::map<PageId, Frame> frames;            // Páginas residentes
+    std::unordered_map<PageId, DiskSlot> disk; // Páginas con copia en disco
+    std::unordered_map<PageId, size_t> writing; // Páginas desalojándose -> bytes
+    PageId nextPageId = 1;
+    PageId clockHand = 0;
+
+    std::string spillPath;
+    int spillFd = -1;
+    off_t spillEnd = 0;
+
+    size_t budget;
+    size_t residentBytes = 0; // Incluye las páginas que se están escribiendo
+    size_t writingBytes = 0;
+    BufferPoolStats counters;
+    std::optional<std::string> pendingError;
+    bool spillFailing = false; // Se informa una vez hasta que una escritura vuelva a funcionar
+
+    std::thread readAheadThread; // Se declara al final: arranca con todo inicializado
+};
@@ -0,0 +1,64 @@
+#pragma once
+
+#include "Row.hpp"
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+// Valores de una columna dentro de una página. Solo se usa el vector de su
+// tipo, así cada valor ocupa su ancho natural (2, 4 u 8 bytes; 1 los BOOLEAN)
+// y los arreglos contiguos se recorren sin saltos. Los NULL se marcan en el
+// bitmap 'validity' (bit a 1 = hay valor); su posición en el arreglo queda a 0.
+struct ColumnVector {
+    std::string name;
+    DataType type = DataType::INTEGER;
+    std::vector<int16_t> smallints;
+    std::vector<int32_t> ints;
+    std::vector<int64_t> bigints;
+    std::vector<double> doubles;
+    std::vector<uint8_t> bools;
+    std::vector<std::string> texts;
+    std::vector<uint64_t> validity;
+
+    bool isValid(size_t row) const {
+        return (validity[row / 64] >> (row % 64)) & 1;
+    }
+    std::optional<CellValue> get(size_t row) const;
+    // Un valor de otro ancho se convierte al tipo de la columna (coerceCell);
+    // nullopt = NULL. Devuelve false si el valor no cabe: la celda queda NULL.
+    bool set(size_t row, const std::optional<CellValue>& value);
+};
+
+// Página del buffer pool: las filas de un bloque guardadas por columnas.
+// Las columnas siguen el orden del esquema de la tabla.
+class ColumnPage
+{
+public:
+    ColumnPage() = default;
+    explicit ColumnPage(const std::vector<Column>& columns);
+
+    size_t size() const { return rowCount; }
+    size_t columnCount() const { return columns.size(); }
+    const ColumnVector& column(size_t index) const { return columns[index]; }
+    ColumnVector& column(size_t index) { return columns[index]; }
+
+    // Agrega una fila; las columnas ausentes quedan en NULL
+    void append(const Row& row);
+    // Arma la fila 'index' (sin las columnas NULL)
+    Row row(size_t index) const;
+    // Conserva solo las filas de 'keep' (posiciones ascendentes)
+    void retain(const std::vector<size_t>& keep);
+
+    size_t memoryBytes() const;
+    // Formato binario para el archivo de intercambio del buffer pool.
+    // deserialize devuelve nullopt si los datos están truncados o dañados.
+    std::string serialize() const;
+    static std::optional<ColumnPage> deserialize(const std::string& data);
+
+private:
+    void resize(size_t rows);
+
+    size_t rowCount = 0;
+    std::vector<ColumnVector> columns;
+};
@@ -8,30 +8,72 @@
 
 enum class CommandType {
     CREATE_TABLE,
+    CREATE_INDEX,
     INSERT,
     SELECT,
     UPDATE,
     DELETE,
+    SHOW_STATS,
+    ANALYZE,
+    SET_OPTION,
+    CHECKPOINT,
     UNRECOGNIZED
 };
 
 struct WhereClause {
     std::string column;
-    std::string op; // =, >, <, >=, <=
+    std::string op; // =, !=, >, <, >=, <=, IS NULL, IS NOT NULL
     std::string value;
 };
 
+enum class ExprType {
+    PREDICATE,
+    AND,
+    OR,
+    NOT
+};
+
+// Árbol de expresión booleana de un WHERE.
+// Las hojas son comparaciones simples (columna op valor).
+struct WhereExpr {
+    ExprType type = ExprType::PREDICATE;
+    WhereClause predicate;           // Solo si type == PREDICATE
+    std::vector<WhereExpr> children; // Operandos de AND/OR (n-arios) y NOT (uno)
+};
+
+// Asignación de UPDATE: columna = valor, o columna = origen op valor
+// (aritmética entera, p. ej. "c = c + 1"). También guarda "opción = valor" de SET.
 struct SetClause {
     std::string column;
     std::string value;
+    std::string sourceColumn; // Solo si op != 0
+    char op = 0;              // +, -, * o /
+};
+
+enum class PartitionMethod {
+    HASH,
+    RANGE
+};
+
+// Esquema de partición de CREATE TABLE ... PARTITION BY. Cada partición es
+// una tabla física propia ("tabla#n") con su segmento en disco.
+struct PartitionScheme {
+    PartitionMethod method = PartitionMethod::HASH;
+    std::string column;
+    size_t count = 0;        // Número de particiones
+    std::vector<int> bounds; // RANGE: límites ascendentes; la partición i guarda [bounds[i-1], bounds[i])
 };
 
 struct Command {
     CommandType type = CommandType::UNRECOGNIZED;
     std::string tableName;
     std::vector<Column> columns; // Para CREATE
+    std::optional<PartitionScheme> partition; // CREATE TABLE ... PARTITION BY
     std::vector<std::string> columnNames; // Para SELECT
     std::vector<std::string> values;
-    std::vector<SetClause> setClauses; // Para UPDATE
-    std::optional<WhereClause> whereClause;
+    std::vector<SetClause> setClauses; // Para UPDATE y SET (opción = valor)
+    std::optional<WhereExpr> whereClause;
+    std::string indexName; // Para CREATE INDEX (la columna va en columnNames)
+    bool explain = false;  // EXPLAIN: mostrar el plan sin ejecutar
+    std::string text;      // Sentencia original (el primario la copia al log de replicación)
 };
\ No newline at end of file
@@ -3,26 +3,186 @@
 #include <string>
 #include "Command.hpp"
 #include <unordered_map>
+#include <unordered_set>
+#include <memory>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <future>
+#include <iostream>
+#include <mutex>
+#include <shared_mutex>
+#include <thread>
 #include "Table.hpp" // Incluimos nuestra nueva clase Table
+#include "Filter.hpp"
+#include "ResultCache.hpp"
+#include "Scheduler.hpp"
+#include "Replication.hpp"
+#ifdef MINIDB_COROUTINES
+#include <coroutine>
+#include <exception>
+#endif
+
+// Fracción de filas borradas a partir de la cual se compacta un bloque
+constexpr double DEFAULT_COMPACTION_THRESHOLD = 0.25;
 
 class Database
 {
 public:
-  // El constructor ahora tomará el nombre del archivo de la BD
-  explicit Database(const std::string &db_name);
+  // El constructor ahora tomará el nombre del archivo de la BD y el
+  // presupuesto de memoria del buffer pool. Con 'prefetchTables' las tablas
+  // se cargan en segundo plano en lugar de esperar a su primer uso.
+  // Como réplica (FOLLOWER), 'db_name' es el catálogo del primario: se lee sin
+  // modificarlo y se aplica su log; solo se aceptan lecturas.
+  explicit Database(const std::string &db_name, size_t memoryBudget = DEFAULT_BUFFER_POOL_BYTES,
+                    bool prefetchTables = false, ReplicationRole role = ReplicationRole::NONE);
   // El destructor se asegurará de guardar al final
   ~Database();
 
   bool createTable(const std::string& tableName, const std::vector<Column>& columns);
   bool insertInto(const std::string& tableName, const Row& row);
-  std::optional<Table> selectFrom(const std::string& tableName);
-  void execute(const Command& command);
+  const Table* selectFrom(const std::string& tableName);
+  // Ejecuta la sentencia en el hilo actual y escribe su salida en 'out'.
+  // Puede llamarse desde varios hilos a la vez.
+  void execute(const Command& command, std::ostream& out = std::cout);
   void executeScript(const std::string& scriptContent);
 
+  // API asíncrona: la sentencia corre en el pool de hilos del planificador
+  // y el future entrega su salida. Las lecturas corren en paralelo y las
+  // escrituras sobre una misma tabla se ejecutan de una en una, en orden.
+  std::future<std::string> submit(Command command);
+
+#ifdef MINIDB_COROUTINES
+  // Variante para corrutinas (C++20): 'co_await db.executeAsync(cmd)' suspende
+  // la corrutina y la reanuda en un hilo del pool con la salida de la sentencia.
+  class StatementAwaiter {
+  public:
+    StatementAwaiter(Database& db, Command command);
+    bool await_ready() const noexcept { return false; }
+    void await_suspend(std::coroutine_handle<> handle);
+    std::string await_resume();
+
+  private:
+    Database& db;
+    Command command;
+    std::string output;
+    std::exception_ptr error;
+  };
+  StatementAwaiter executeAsync(Command command);
+#endif
+
+  // Checkpoint incremental síncrono; devuelve false si falló la escritura
+  bool checkpoint();
+  // Pide un checkpoint al hilo de fondo sin esperar a que termine
+  void requestCheckpoint();
+
 private:
-  void load(); // Carga la BD desde el archivo
-  void save(); // Guarda la BD en el archivo
+  void load(); // Carga el catálogo; las filas de cada tabla se cargan al usarla
+  void loadCatalog(std::istream& catalog);
+  // Toma los bloqueos de la sentencia y la ejecuta (execute() sin el control de réplica)
+  void applyStatement(const Command& command, std::ostream& out);
+  // executeLocked + logStatement; informa los errores de E/S del buffer pool
+  void runLocked(const Command& command, std::ostream& out);
+  // Cuerpo de execute(), con los bloqueos ya tomados
+  void executeLocked(const Command& command, std::ostream& out);
+  void logStatement(const Command& command, std::ostream& out);
+  void schedule(const Command& command, Scheduler::Job job, Scheduler::Job then = nullptr);
+  Table* getTable(const std::string& tableName);
+  std::vector<std::string> targetTables(const Command& command) const;
+  std::vector<std::pair<std::string, Table*>> resolveTargets(const Command& command);
+  const Table* schemaTable(const std::string& tableName);
+  void explainTargets(const Command& command, const std::vector<std::pair<std::string, Table*>>& targets,
+                      std::ostream& out);
+  // Sin 'stateMutex' tomado. false (informado en 'out') si el segmento no se pudo leer
+  bool ensureLoaded(const std::string& tableName, std::ostream& out);
+  // Tablas que la sentencia necesita cargadas
+  std::vector<std::string> tablesToLoad(const Command& command) const;
+  bool isUnloaded(const std::vector<std::string>& tableNames);
+  static bool readSegment(const std::string& path, size_t expectedBytes, Table& table, std::ostream& out);
+  // Reserva hasta 'wanted' hilos auxiliares de recorrido sin pasar del límite global
+  size_t reserveScanThreads(size_t wanted);
+  // Ejecuta 'work' para cada partición en [0, count) entre el hilo de la sentencia
+  // y los auxiliares reservados; relanza la primera excepción al terminar todas
+  void forEachTarget(size_t count, const std::function<void(size_t)>& work);
+  void prefetchLoop();
+  bool resync();
+  void replicationLoop();
+  void checkpointLoop();
+  void compactionLoop();
+  // Compacta un bloque que supere el umbral; devuelve false si no queda ninguno
+  bool compactNextBlock(double threshold);
+
+  // Segmento en disco de cada tabla y la versión de la tabla que contiene
+  struct SegmentState {
+    std::string file;
+    uint64_t version = 0;
+    size_t rows = 0;  // Filas y tamaño del archivo, guardados en el catálogo
+    size_t bytes = 0;
+  };
 
   std::string db_name;
-  std::unordered_map<std::string, Table> tables;
+  std::shared_ptr<BufferPool> bufferPool; // Páginas de filas de todas las tablas
+  std::unordered_map<std::string, Table> tables; // Tablas físicas (incluye las particiones "tabla#n")
+  std::unordered_map<std::string, PartitionScheme> partitionSchemes; // Tablas particionadas
+  PredicateStatsMap predicateStats; // Selectividad observada de los predicados WHERE
+  ResultCache resultCache;          // Resultados de SELECT (SET result_cache_mb = N)
+
+  // Lecturas y escrituras toman 'stateMutex' compartido y luego el bloqueo de
+  // su tabla (compartido o exclusivo). Lo que afecta a varias tablas (DDL,
+  // SHOW STATS, SET, checkpoints, compactación) toma 'stateMutex' exclusivo.
+  std::shared_mutex stateMutex;
+  std::unordered_map<std::string, std::unique_ptr<std::shared_mutex>> tableLocks;
+  std::mutex checkpointMutex; // Un checkpoint a la vez
+  std::mutex segmentsMutex;   // Protege 'segments', 'unloadedTables' y 'loadingTables'
+  std::unordered_map<std::string, SegmentState> segments;
+  std::unordered_set<std::string> unloadedTables; // Solo se leyó su entrada de catálogo
+  std::unordered_set<std::string> loadingTables;  // Un hilo está leyendo su segmento
+  std::condition_variable segmentsCv;             // Avisa cuando termina una carga
+  uint64_t segmentSequence = 0;
+  std::string lastCatalog; // Último catálogo publicado
+  std::atomic<uint64_t> checkpointsDone{0};
+  std::atomic<size_t> lastCheckpointTables{0};
+  std::atomic<size_t> lastCheckpointBytes{0};
+
+  // Hilo de checkpoints: despierta por temporizador o por requestCheckpoint()
+  std::mutex checkpointSignalMutex;
+  std::condition_variable checkpointCv;
+  bool checkpointRequested = false;
+  bool checkpointIntervalChanged = false;
+  bool stopping = false;
+  std::chrono::seconds checkpointInterval{30};
+  std::thread checkpointThread;
+
+  // Hilo de compactación: despierta tras un DELETE o periódicamente, y
+  // reescribe los bloques con demasiadas filas borradas de uno en uno
+  std::mutex compactionSignalMutex;
+  std::condition_variable compactionCv;
+  bool compactionRequested = false;
+  bool compactionStopping = false;
+  double compactionThreshold = DEFAULT_COMPACTION_THRESHOLD; // 0 = desactivada
+  std::thread compactionThread;
+
+  std::atomic<bool> prefetchStopping{false};
+  std::thread prefetchThread; // Solo si se pidió precargar las tablas
+
+  // Replicación: el primario añade cada sentencia que modifica datos al log y
+  // lo recorta en cada checkpoint; la réplica lo aplica desde su propio hilo.
+  ReplicationRole replicationRole;
+  ReplicationLog replicationLog; // Solo en el primario
+  int64_t catalogEpoch = 0;      // [REPLICATION:época lsn] del catálogo: hasta
+  uint64_t catalogLsn = 0;       // dónde llega la foto del último checkpoint
+  LogReader logReader;           // Solo en la réplica
+  std::atomic<bool> replicaSynced{false}; // La réplica tiene una foto y sigue el log
+  int64_t replicaEpoch = 0;
+  std::atomic<uint64_t> appliedLsn{0};
+  std::atomic<uint64_t> receivedLsn{0};
+  std::atomic<int64_t> replicationLagMs{0}; // Del registro en el primario a su aplicación
+  std::atomic<uint64_t> resyncCount{0};
+  std::atomic<bool> replicationStopping{false};
+  std::thread replicationThread;
+
+  std::once_flag schedulerOnce;
+  std::unique_ptr<Scheduler> scheduler; // Se crea con el primer submit()
+  // Hilos auxiliares que recorren particiones, sumando todas las sentencias
+  std::atomic<size_t> scanThreads{0};
 };
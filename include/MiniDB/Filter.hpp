@@ -0,0 +1,87 @@
+#pragma once
+
+#include "Command.hpp"
+#include "Table.hpp"
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Contadores acumulados de un predicado simple, usados para estimar su selectividad
+struct PredicateStats {
+    uint64_t evaluated = 0;
+    uint64_t passed = 0;
+};
+
+// Historial compartido por todas las sentencias. Clave: "tabla.columna op"
+// (ej: "inventario.cantidad <="). Varias lecturas pueden ejecutarse a la vez,
+// así que el acceso se protege con 'mutex'.
+struct PredicateStatsMap {
+    std::mutex mutex;
+    std::unordered_map<std::string, PredicateStats> entries;
+};
+
+// Versión compilada de un WhereExpr para una tabla concreta.
+// Los literales se convierten una sola vez al tipo de la columna y cada hoja
+// se evalúa recorriendo el arreglo de la columna en la página, sobre vectores
+// de selección. Los operandos de AND/OR se reordenan según su
+// costo y la selectividad observada hasta el momento.
+class Filter
+{
+public:
+    Filter(const WhereExpr& expr, const std::vector<Column>& columns,
+           const std::string& tableName, PredicateStatsMap& stats);
+    // Al destruirse vuelca los contadores observados en 'stats'
+    ~Filter();
+
+    Filter(const Filter&) = delete;
+    Filter& operator=(const Filter&) = delete;
+
+    // false si los zone maps garantizan que ninguna fila del bloque cumple
+    bool mayMatch(const RowBlock& block) const;
+    // Reduce 'selection' a las filas del bloque que cumplen la expresión
+    void select(const ColumnPage& page, std::vector<size_t>& selection);
+
+    BlockFilter blockFilter() const;
+    RowSelector selector();
+
+private:
+    enum class CompareOp { EQ, NE, GT, LT, GE, LE, IS_NULL, IS_NOT_NULL };
+
+    struct Node {
+        ExprType type = ExprType::PREDICATE;
+        // Hojas
+        std::string column;
+        std::optional<size_t> columnIndex; // nullopt si la tabla no tiene la columna
+        DataType columnType = DataType::TEXT;
+        CompareOp op = CompareOp::EQ;
+        std::string text;          // Literal tal cual para columnas TEXT
+        int64_t integer = 0;       // Literal convertido para columnas enteras
+        double real = 0;           // ... para columnas DOUBLE
+        bool flag = false;         // ... para columnas BOOLEAN
+        bool literalValid = false; // false con el literal NULL o uno que no es del tipo de la columna
+        std::string statsKey;
+        PredicateStats history;    // Estadísticas previas a esta sentencia
+        PredicateStats seen;       // Contadores de esta sentencia
+        double cost = 1.0;
+        // Nodos internos
+        std::vector<Node> children;
+    };
+
+    Node compile(const WhereExpr& expr, const std::vector<Column>& columns, const std::string& tableName);
+    static double selectivity(const Node& node);
+    static bool nodeMayMatch(const Node& node, const RowBlock& block);
+    static void evaluateLeaf(const Node& node, const ColumnPage& page, const std::vector<size_t>& in,
+                             std::vector<size_t>& out);
+    // Lógica de tres valores: 'evaluate' deja las filas donde el nodo es TRUE y
+    // 'evaluateFalse' las filas donde es FALSE. Las demás son UNKNOWN (una
+    // comparación con NULL), que NOT no convierte en TRUE.
+    void evaluate(Node& node, const ColumnPage& page, const std::vector<size_t>& in, std::vector<size_t>& out);
+    void evaluateFalse(Node& node, const ColumnPage& page, const std::vector<size_t>& in, std::vector<size_t>& out);
+    void commit(const Node& node);
+
+    Node root;
+    PredicateStatsMap& stats;
+};
@@ -8,7 +8,9 @@ public:
     Command parse(const std::string& query);
 
 private:
+    Command parseStatement(const std::string& statement);
     Command parseCreate(std::vector<std::string>& tokens);
+    Command parseCreateIndex(std::vector<std::string>& tokens);
     Command parseInsert(std::vector<std::string>& tokens);
     Command parseSelect(std::vector<std::string>& tokens);
     Command parseDelete(std::vector<std::string>& tokens);
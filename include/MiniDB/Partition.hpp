@@ -0,0 +1,28 @@
+#pragma once
+
+#include "Command.hpp"
+#include <optional>
+#include <string>
+#include <vector>
+
+// Separador entre el nombre de la tabla y el número de partición
+constexpr char PARTITION_SEPARATOR = '#';
+// Máximo de particiones por tabla, HASH o RANGE (límites + 1): cada una es una tabla física
+constexpr size_t MAX_PARTITIONS = 256;
+
+// Nombre de la tabla física de una partición: "tabla#n"
+std::string partitionName(const std::string& tableName, size_t index);
+
+// Partición donde va una fila. Las filas sin valor en la columna de
+// partición van a la primera.
+size_t partitionFor(const PartitionScheme& scheme, const Row& row);
+
+// Particiones que pueden contener filas que cumplan 'where', en orden.
+// Se usan las comparaciones sobre la columna de partición combinadas con
+// AND (intersección) y OR (unión) a cualquier profundidad; bajo NOT no se poda.
+std::vector<size_t> prunePartitions(const PartitionScheme& scheme, DataType keyType,
+                                    const std::optional<WhereExpr>& where);
+
+// Representación del esquema en el catálogo: "HASH col n" o "RANGE col k b1 .. bk"
+std::string formatScheme(const PartitionScheme& scheme);
+std::optional<PartitionScheme> parseScheme(const std::string& text);
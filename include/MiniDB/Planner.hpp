@@ -0,0 +1,36 @@
+#pragma once
+
+#include "Command.hpp"
+#include "Table.hpp"
+#include <optional>
+#include <string>
+
+enum class AccessMethod {
+    FULL_SCAN,
+    INDEX_LOOKUP,
+    INDEX_RANGE_SCAN
+};
+
+// Camino de acceso elegido para una sentencia sobre una tabla
+struct AccessPlan {
+    AccessMethod method = AccessMethod::FULL_SCAN;
+    std::string column;          // Columna del índice usado
+    CellValue key;               // Para INDEX_LOOKUP
+    std::optional<int64_t> low;  // Para INDEX_RANGE_SCAN
+    std::optional<int64_t> high;
+    bool lowInclusive = true;
+    bool highInclusive = true;
+    double estimatedRows = 0;
+    double cost = 0;
+};
+
+// Elige entre recorrido completo, búsqueda exacta y rango por índice usando
+// las estadísticas de ANALYZE (o valores por defecto si no existen).
+// Solo se consideran los predicados de nivel superior unidos por AND.
+AccessPlan choosePlan(const Table& table, const std::optional<WhereExpr>& where);
+
+// Filas candidatas del plan (nullopt para FULL_SCAN)
+std::optional<CandidateMap> fetchCandidates(const Table& table, const AccessPlan& plan);
+
+// Descripción legible del plan para EXPLAIN
+std::string describePlan(const Table& table, const std::string& tableName, const AccessPlan& plan);
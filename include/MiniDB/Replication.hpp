@@ -0,0 +1,85 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <vector>
+
+// Papel del proceso en la replicación por envío de log
+enum class ReplicationRole {
+    NONE,     // Sin replicación
+    PRIMARY,  // Escribe cada sentencia que modifica datos en el log
+    FOLLOWER  // Réplica de solo lectura: aplica el log del primario
+};
+
+// Cada cuánto revisa una réplica si el log creció
+constexpr std::chrono::milliseconds REPLICATION_POLL_INTERVAL{100};
+
+// Registro lógico del log: una sentencia ya ejecutada en el primario.
+// En disco es una línea "LSN milisegundos SQL".
+struct LogRecord {
+    uint64_t lsn = 0;
+    int64_t timestampMs = 0; // Hora del primario al escribir el registro
+    std::string sql;
+};
+
+// Cabecera del log: "[LOG:época lsnInicial]". La época cambia cada vez que
+// arranca el primario; el LSN inicial es el del checkpoint del que parte.
+struct LogHeader {
+    int64_t epoch = 0;
+    uint64_t startLsn = 0;
+};
+
+// El log vive junto al catálogo: "<catálogo>.log"
+std::string replicationLogPath(const std::string& dbName);
+int64_t currentTimeMillis();
+
+// Log del primario. Solo se añaden registros; en cada checkpoint se reemplaza
+// por uno que conserva solo los registros posteriores al checkpoint.
+class ReplicationLog
+{
+public:
+    // Empieza un log nuevo (reemplaza el anterior) a continuación de 'startLsn'
+    bool open(const std::string& path, int64_t epoch, uint64_t startLsn);
+    bool isOpen() const;
+    uint64_t append(const std::string& sql); // Devuelve el LSN asignado
+    uint64_t lastLsn() const;
+    int64_t getEpoch() const;
+    // Descarta los registros hasta 'lsn' (incluido), ya guardados por un checkpoint
+    bool truncateThrough(uint64_t lsn);
+
+private:
+    mutable std::mutex mutex;
+    std::string path;
+    std::ofstream file;
+    int64_t epoch = 0;
+    uint64_t lsn = 0;
+};
+
+// Lectura incremental del log en una réplica. Mantiene el archivo abierto:
+// si el primario lo reemplaza, termina de leer el anterior antes de pasar al nuevo.
+class LogReader
+{
+public:
+    explicit LogReader(std::string path);
+    ~LogReader();
+
+    LogReader(const LogReader&) = delete;
+    LogReader& operator=(const LogReader&) = delete;
+
+    // Abre el log actual y devuelve su cabecera
+    std::optional<LogHeader> open();
+    // Registros completos añadidos desde la última llamada. 'replaced' indica
+    // que el archivo abierto ya se leyó entero y el primario publicó otro:
+    // hay que volver a llamar a open().
+    std::vector<LogRecord> poll(bool& replaced);
+
+private:
+    std::string path;
+    int fd = -1;
+    unsigned long inode = 0;
+    std::string partial; // Línea a medio escribir por el primario
+};
@@ -0,0 +1,59 @@
+#pragma once
+
+#include "Command.hpp"
+#include <cstdint>
+#include <atomic>
+#include <list>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+
+struct ResultCacheStats {
+    size_t capacity = 0;
+    size_t bytes = 0;
+    size_t entries = 0;
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    uint64_t evictions = 0;
+    uint64_t invalidations = 0; // Entradas descartadas porque la tabla cambió
+};
+
+// Caché de resultados de SELECT ya formateados, con límite de memoria y
+// desalojo LRU. Cada entrada guarda la versión de la tabla con la que se
+// calculó; si la tabla cambió desde entonces, la entrada deja de ser válida.
+// Con capacidad 0 (por defecto) la caché está desactivada. Es segura entre hilos.
+class ResultCache
+{
+public:
+    void setCapacity(size_t bytes);
+    bool isEnabled() const;
+
+    // Devuelve el resultado guardado si sigue siendo válido
+    std::optional<std::string> lookup(const std::string& key, uint64_t tableVersion);
+    void insert(const std::string& key, uint64_t tableVersion, std::string result);
+    // Descarta todas las entradas (las versiones de las tablas dejaron de ser comparables)
+    void clear();
+
+    ResultCacheStats getStats() const;
+
+private:
+    struct Entry {
+        std::string key;
+        uint64_t version;
+        std::string result;
+    };
+
+    void erase(std::list<Entry>::iterator it);
+    void evictIfNeeded();
+
+    std::list<Entry> lru; // La más reciente al frente
+    std::unordered_map<std::string, std::list<Entry>::iterator> entries;
+    mutable std::mutex mutex; // Varios SELECT pueden consultar la caché a la vez
+    std::atomic<size_t> capacity{0};
+    size_t bytes = 0;
+    ResultCacheStats counters;
+};
+
+// Clave normalizada de un SELECT: tabla, columnas y predicado
+std::string resultCacheKey(const Command& command);
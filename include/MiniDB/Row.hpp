@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <variant>
+
+enum class DataType {
+    INTEGER,  // Entero de 32 bits
+    TEXT,
+    BIGINT,   // Entero de 64 bits
+    SMALLINT, // Entero de 16 bits
+    DOUBLE,
+    BOOLEAN
+};
+
+struct Column {
+    std::string name;
+    DataType type;
+};
+
+// Representa una fila como un mapa de nombre de columna a valor
+// Usamos std::variant para poder almacenar diferentes tipos de datos:
+// cada tipo numérico con su ancho natural. Una columna ausente es NULL.
+using CellValue = std::variant<int, std::string, int64_t, int16_t, double, bool>;
+using Row = std::unordered_map<std::string, CellValue>;
+
+// Nombre SQL de un tipo y su inverso
+std::string typeName(DataType type);
+std::optional<DataType> parseType(const std::string& name);
+// SMALLINT, INTEGER y BIGINT: comparten zone maps y aritmética entera
+bool isIntegral(DataType type);
+bool isNumeric(DataType type);
+
+// Literal NULL (sin comillas)
+bool isNullLiteral(const std::string& text);
+// Convierte un literal al tipo de la columna; nullopt si no es válido o no cabe
+std::optional<CellValue> parseCell(const std::string& text, DataType type);
+// Convierte un valor al tipo de una columna (los reales a enteros, truncando);
+// nullopt si no es compatible o no cabe (fuera de rango, NaN o infinito)
+std::optional<CellValue> coerceCell(const CellValue& value, DataType type);
+// Valor de una celda entera (de cualquier ancho) o real
+std::optional<int64_t> integralValue(const CellValue& value);
+std::optional<double> numericValue(const CellValue& value);
+// Texto de una celda: BOOLEAN como TRUE/FALSE y DOUBLE sin perder precisión
+std::string formatCell(const CellValue& value);
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+// Tipo de acceso de una sentencia
+enum class AccessMode {
+    READ,     // Lee una tabla: puede correr junto a otras lecturas de la misma tabla
+    WRITE,    // Modifica una tabla: una a la vez por tabla
+    EXCLUSIVE // Afecta a toda la base de datos: corre sola
+};
+
+// Planificador acotado de sentencias sobre un pool de hilos. Respeta el orden
+// de llegada entre sentencias que entran en conflicto (misma tabla con al
+// menos una escritura, o cualquier sentencia EXCLUSIVE) y deja correr en
+// paralelo el resto.
+class Scheduler
+{
+public:
+    using Job = std::function<void()>;
+
+    Scheduler(size_t workerCount, size_t maxQueued);
+    // Termina las tareas pendientes antes de detener los hilos
+    ~Scheduler();
+
+    Scheduler(const Scheduler&) = delete;
+    Scheduler& operator=(const Scheduler&) = delete;
+
+    // Encola una tarea; si la cola está llena espera a que haya lugar.
+    // 'then' corre en el mismo hilo después de liberar la tabla, para que
+    // una continuación pueda encolar y esperar otras sentencias.
+    void enqueue(const std::string& table, AccessMode mode, Job job, Job then = nullptr);
+
+private:
+    struct Task {
+        std::string table;
+        AccessMode mode;
+        Job job;
+        Job then;
+    };
+
+    // Requieren tener tomado 'mutex'
+    bool canRun(size_t position) const;
+    void markRunning(const Task& task, bool running);
+    void workerLoop();
+
+    std::mutex mutex;
+    std::condition_variable workAvailable;
+    std::condition_variable spaceAvailable;
+    std::deque<Task> queue;
+    size_t maxQueued;
+    bool stopping = false;
+
+    size_t running = 0;
+    bool exclusiveRunning = false;
+    std::unordered_map<std::string, size_t> runningReaders;
+    std::unordered_set<std::string> runningWriters;
+
+    std::vector<std::thread> workers;
+};
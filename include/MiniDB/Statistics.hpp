@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+class Table;
+
+// Estimador de valores distintos HyperLogLog con 2^precision registros
+class HyperLogLog
+{
+public:
+    explicit HyperLogLog(int precision = 10);
+
+    void add(uint64_t hash);
+    double estimate() const;
+
+private:
+    int precision;
+    std::vector<uint8_t> registers;
+};
+
+// Estadísticas de una columna recogidas por ANALYZE
+struct ColumnStats {
+    double distinct = 0;        // Valores distintos estimados (HyperLogLog)
+    size_t nullCount = 0;
+    std::vector<int64_t> histogram; // Límites de un histograma equi-depth (columnas enteras)
+};
+
+struct TableStats {
+    bool analyzed = false;
+    size_t rowCount = 0;        // Filas al momento de ANALYZE
+    std::unordered_map<std::string, ColumnStats> columns;
+};
+
+// Recorre la tabla completa y calcula sus estadísticas
+TableStats analyzeTable(const Table& table);
+
+// Fracción estimada de filas con columna = valor. Sin estadísticas usa un valor por defecto.
+double estimateEquality(const ColumnStats* stats, size_t rowCount, std::optional<int64_t> value);
+
+// Fracción estimada de filas dentro del rango [low, high] (cada extremo es opcional)
+double estimateRange(const ColumnStats* stats, size_t rowCount,
+                     std::optional<int64_t> low, bool lowInclusive,
+                     std::optional<int64_t> high, bool highInclusive);
@@ -6,35 +6,156 @@
 #include <optional>
 #include <variant>
 #include <functional>
+#include <map>
+#include <memory>
+#include <atomic>
+#include <mutex>
+#include "Row.hpp"
+#include "BufferPool.hpp"
+#include "ColumnPage.hpp"
+#include "Statistics.hpp"
 
-enum class DataType {
-    INTEGER,
-    TEXT
+// Número máximo de filas por bloque de almacenamiento
+constexpr size_t BLOCK_SIZE = 1024;
+
+// Metadatos min/max de una columna entera (SMALLINT, INTEGER o BIGINT)
+// dentro de un bloque (zone map)
+struct ZoneMap {
+    int64_t min = 0;
+    int64_t max = 0;
+    size_t nullCount = 0;   // Filas del bloque sin valor en esta columna
+    bool hasValues = false; // false si todas las filas del bloque son nulas
+};
+
+// Metadatos de un bloque de filas: sus zone maps (solo para columnas enteras)
+// y la página del buffer pool donde viven las filas.
+// Borrar solo marca la fila en el bitmap 'deleted'; las posiciones no cambian
+// hasta que el compactador reescribe el bloque.
+struct RowBlock {
+    PageId page = 0;
+    size_t rowCount = 0;           // Filas en la página, incluidas las borradas
+    size_t deletedCount = 0;
+    std::vector<uint64_t> deleted; // Bitmap de filas borradas (tombstones)
+    std::unordered_map<std::string, ZoneMap> zones;
+
+    bool isDeleted(size_t slot) const {
+        return slot / 64 < deleted.size() && ((deleted[slot / 64] >> (slot % 64)) & 1);
+    }
+    void markDeleted(size_t slot) {
+        if (deleted.size() <= slot / 64) deleted.resize(slot / 64 + 1, 0);
+        deleted[slot / 64] |= uint64_t(1) << (slot % 64);
+        deletedCount++;
+    }
 };
 
-struct Column {
-    std::string name;
-    DataType type;
+// Decide si un bloque puede contener filas que cumplan una condición.
+// Si devuelve false, el bloque completo se omite.
+using BlockFilter = std::function<bool(const RowBlock&)>;
+
+// Recibe en 'selection' los índices de las filas candidatas de un bloque y
+// lo reduce a las que cumplen la condición (vector de selección).
+using RowSelector = std::function<void(const ColumnPage& page, std::vector<size_t>& selection)>;
+
+// Modifica de una vez todas las filas seleccionadas de un bloque
+using RowBatchUpdate = std::function<void(ColumnPage& page, const std::vector<size_t>& selection)>;
+
+// Posición de una fila dentro de la tabla
+struct RowId {
+    size_t block;
+    size_t slot;
 };
 
-// Representa una fila como un mapa de nombre de columna a valor
-// Usamos std::variant para poder almacenar diferentes tipos de datos.
-using CellValue = std::variant<int, std::string>;
-using Row = std::unordered_map<std::string, CellValue>;
+// Índice secundario: valor de la columna -> filas que lo contienen
+using RowIndex = std::map<CellValue, std::vector<RowId>>;
+
+// Filas candidatas por bloque (posiciones ordenadas), resultado de consultar un índice
+using CandidateMap = std::map<size_t, std::vector<size_t>>;
 
 class Table
 {
 public:
-    Table() = default;
-    explicit Table(std::vector<Column> columns);
+    // Las filas se guardan en páginas de 'pool'
+    Table(std::vector<Column> columns, std::shared_ptr<BufferPool> pool);
+    ~Table();
+
+    Table(const Table&) = delete;
+    Table& operator=(const Table&) = delete;
 
     bool insert(const Row& row);
-    int deleteRows(std::function<bool(const Row&)> condition);
-    int updateRows(std::function<bool(const Row&)> condition, std::function<void(Row&)> updateAction);
-    const std::vector<Row>& getRows() const;
+    // Un selector nulo selecciona todas las filas
+    // y 'candidates' (si no es nulo) limita el recorrido a las filas de un índice.
+    int deleteRows(const RowSelector& selector, const BlockFilter& blockFilter = nullptr,
+                   const CandidateMap* candidates = nullptr);
+    // 'changedColumns' son las columnas que modifica 'updateAction': solo sus
+    // índices se corrigen, fila por fila, con los valores nuevos.
+    int updateRows(const RowSelector& selector, const RowBatchUpdate& updateAction,
+                   const std::vector<std::string>& changedColumns,
+                   const BlockFilter& blockFilter = nullptr, const CandidateMap* candidates = nullptr);
+    // Recorre las filas seleccionadas de los bloques que pasan el filtro
+    void scan(const BlockFilter& blockFilter, const RowSelector& selector,
+              const std::function<void(const Row&)>& visitor, const CandidateMap* candidates = nullptr) const;
+    // Agrega un bloque completo (usado al cargar desde archivo).
+    // Si 'zones' no cubre todas las columnas enteras, se recalculan.
+    void appendBlock(std::vector<Row> blockRows, std::unordered_map<std::string, ZoneMap> zones = {});
+    // Mueve al final los bloques de 'source' (mismas columnas y pool) sin copiar sus páginas
+    void appendBlocks(Table& source);
+    // Compactación: reescribe un bloque sin sus filas borradas
+    std::optional<size_t> findCompactionCandidate(double deadRatio) const;
+    void compactBlock(size_t blockIndex);
+    // Recorre todos los bloques con sus filas (para guardar en disco).
+    // Las filas borradas siguen en la página; usar RowBlock::isDeleted.
+    void forEachBlock(const std::function<void(const RowBlock&, const ColumnPage&)>& visitor) const;
+
+    // Índices secundarios (uno por columna)
+    bool createIndex(const std::string& indexName, const std::string& column);
+    bool hasIndex(const std::string& column) const;
+    std::string getIndexName(const std::string& column) const;
+    std::vector<std::string> getIndexedColumns() const;
+    CandidateMap indexLookup(const std::string& column, const CellValue& key) const;
+    CandidateMap indexRange(const std::string& column, std::optional<int64_t> low, bool lowInclusive,
+                            std::optional<int64_t> high, bool highInclusive) const;
+
+    // Estadísticas recogidas por ANALYZE
+    void setStats(TableStats newStats);
+    const TableStats& getStats() const;
+
+    const std::vector<RowBlock>& getBlocks() const;
     const std::vector<Column>& getColumns() const;
+    size_t getRowCount() const;
+    size_t getRowsSkipped() const;
+    size_t getDeletedRowCount() const;
+    size_t getCompactedBlocks() const;
+    // Aumenta con cada cambio en las filas (para checkpoints incrementales)
+    uint64_t getVersion() const;
 
 private:
+    // Las posiciones cambian al compactar y los valores al actualizar, así que
+    // el índice se marca como obsoleto y se reconstruye en la próxima consulta.
+    // Las filas borradas se descartan al preparar la selección.
+    struct Index {
+        std::string name;
+        mutable RowIndex entries;
+        mutable bool stale = true;
+    };
+
+    const RowIndex& ensureIndex(const std::string& column, const Index& index) const;
+    void invalidateIndexes();
+    static void moveIndexEntry(RowIndex& entries, const std::optional<CellValue>& before,
+                               const std::optional<CellValue>& after, RowId id);
+    bool prepareSelection(size_t blockIndex, const CandidateMap* candidates, std::vector<size_t>& selection) const;
+    void prefetchAfter(size_t blockIndex, const BlockFilter& blockFilter, const CandidateMap* candidates) const;
+    void recomputeZones(RowBlock& block, const ColumnPage& page) const;
+    void extendZones(RowBlock& block, const ColumnPage& page, size_t slot) const;
+
     std::vector<Column> columns;
-    std::vector<Row> rows;
-};
\ No newline at end of file
+    std::shared_ptr<BufferPool> pool;
+    std::vector<RowBlock> blocks;
+    std::map<std::string, Index> indexes; // Columna -> índice
+    TableStats stats;
+    // Varias lecturas pueden recorrer la tabla a la vez: estos miembros son los
+    // únicos que cambian en un recorrido
+    mutable std::atomic<size_t> rowsSkipped{0}; // Filas omitidas gracias a los zone maps
+    mutable std::mutex indexMutex;              // Reconstrucción de índices obsoletos
+    uint64_t version = 0;
+    size_t compactedBlocks = 0;
+};
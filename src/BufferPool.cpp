@@ -0,0 +1,359 @@
+#include "MiniDB/BufferPool.hpp"
+#include <cstdio>
+#include <stdexcept>
+#include <fcntl.h>
+#include <unistd.h>
+
+PageHandle::PageHandle(BufferPool* p, PageId id, ColumnPage* page)
+    : pool(p), pageId(id), data(page) {}
+
+PageHandle::PageHandle(PageHandle&& other) noexcept
+    : pool(other.pool), pageId(other.pageId), data(other.data), dirty(other.dirty)
+{
+    other.pool = nullptr;
+}
+
+PageHandle& PageHandle::operator=(PageHandle&& other) noexcept
+{
+    if (this != &other) {
+        release();
+        pool = other.pool;
+        pageId = other.pageId;
+        data = other.data;
+        dirty = other.dirty;
+        other.pool = nullptr;
+    }
+    return *this;
+}
+
+PageHandle::~PageHandle()
+{
+    release();
+}
+
+ColumnPage& PageHandle::page() const
+{
+    return *data;
+}
+
+void PageHandle::markDirty()
+{
+    dirty = true;
+}
+
+void PageHandle::release()
+{
+    if (pool) {
+        pool->unpin(pageId, dirty);
+        pool = nullptr;
+    }
+}
+
+BufferPool::BufferPool(size_t memoryBudget, std::string path)
+    : spillPath(std::move(path)), budget(memoryBudget)
+{
+    readAheadThread = std::thread(&BufferPool::readAheadLoop, this);
+}
+
+BufferPool::~BufferPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    readAheadCv.notify_all();
+    readAheadThread.join();
+
+    if (spillFd >= 0) {
+        ::close(spillFd);
+        std::remove(spillPath.c_str()); // El archivo de intercambio es temporal
+    }
+}
+
+PageId BufferPool::allocate(ColumnPage page)
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    PageId id = nextPageId++;
+    Frame& frame = frames[id];
+    frame.page = std::move(page);
+    frame.dirty = true;
+    frame.bytes = frame.page.memoryBytes();
+    residentBytes += frame.bytes;
+    // Una carga masiva no debe superar el presupuesto hasta el próximo unpin
+    evictIfNeeded(lock);
+    return id;
+}
+
+PageHandle BufferPool::pin(PageId id)
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    Frame& frame = load(lock, id);
+    frame.pinCount++;
+    frame.referenced = true;
+    evictIfNeeded(lock); // La página fijada no se desaloja: 'frame' sigue siendo válido
+    return PageHandle(this, id, &frame.page);
+}
+
+void BufferPool::prefetch(PageId id)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (frames.count(id) || isBusy(id) || !disk.count(id)) return; // Ya está en memoria
+        readAheadQueue.push_back(id);
+    }
+    readAheadCv.notify_one();
+}
+
+void BufferPool::free(PageId id)
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    frameCv.wait(lock, [&] { return !isBusy(id); });
+    auto it = frames.find(id);
+    if (it != frames.end()) {
+        residentBytes -= it->second.bytes;
+        frames.erase(it);
+    }
+    // El espacio en disco no se reutiliza; el archivo se descarta al cerrar
+    disk.erase(id);
+}
+
+void BufferPool::setBudget(size_t bytes)
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    budget = bytes;
+    evictIfNeeded(lock);
+}
+
+std::optional<std::string> BufferPool::takeError()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    auto error = std::move(pendingError);
+    pendingError.reset();
+    return error;
+}
+
+BufferPoolStats BufferPool::getStats() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    BufferPoolStats stats = counters;
+    stats.budget = budget;
+    stats.residentBytes = residentBytes;
+    stats.residentPages = frames.size();
+    stats.totalPages = frames.size() + writing.size();
+    for (const auto& pair : disk) {
+        if (!frames.count(pair.first) && !writing.count(pair.first)) stats.totalPages++;
+    }
+    return stats;
+}
+
+void BufferPool::unpin(PageId id, bool dirty)
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    auto it = frames.find(id);
+    if (it == frames.end()) return; // La página fue liberada mientras estaba fijada
+    Frame& frame = it->second;
+    frame.pinCount--;
+    if (dirty) {
+        frame.dirty = true;
+        residentBytes -= frame.bytes;
+        frame.bytes = frame.page.memoryBytes();
+        residentBytes += frame.bytes;
+    }
+    evictIfNeeded(lock);
+}
+
+// Una página que se está leyendo o escribiendo no se puede tocar todavía
+bool BufferPool::isBusy(PageId id) const
+{
+    auto it = frames.find(id);
+    return (it != frames.end() && it->second.loading) || writing.count(id);
+}
+
+static bool readFully(int fd, char* data, size_t size, off_t offset)
+{
+    while (size > 0) {
+        ssize_t n = ::pread(fd, data, size, offset);
+        if (n <= 0) return false;
+        data += n;
+        size -= n;
+        offset += n;
+    }
+    return true;
+}
+
+static bool writeFully(int fd, const char* data, size_t size, off_t offset)
+{
+    while (size > 0) {
+        ssize_t n = ::pwrite(fd, data, size, offset);
+        if (n <= 0) return false;
+        data += n;
+        size -= n;
+        offset += n;
+    }
+    return true;
+}
+
+BufferPool::Frame& BufferPool::load(std::unique_lock<std::mutex>& lock, PageId id, bool prefetching)
+{
+    // Si otro hilo la está leyendo o escribiendo, se espera a que termine
+    frameCv.wait(lock, [&] { return !isBusy(id); });
+    auto it = frames.find(id);
+    if (it != frames.end()) {
+        counters.hits++;
+        return it->second;
+    }
+
+    auto slotIt = disk.find(id);
+    if (slotIt == disk.end()) {
+        throw std::out_of_range("BufferPool: página inexistente");
+    }
+    if (prefetching) {
+        counters.prefetches++;
+    } else {
+        counters.misses++;
+    }
+
+    // El marco queda 'loading' durante la lectura: no se desaloja ni se libera
+    DiskSlot slot = slotIt->second;
+    int fd = spillFd;
+    Frame& frame = frames[id];
+    frame.loading = true;
+    lock.unlock();
+
+    std::string data(slot.size, '\0');
+    std::optional<ColumnPage> page;
+    if (readFully(fd, &data[0], data.size(), slot.offset)) {
+        page = ColumnPage::deserialize(data);
+    }
+
+    lock.lock();
+    frame.loading = false;
+    frameCv.notify_all();
+    if (!page) {
+        frames.erase(id);
+        throw std::runtime_error("no se pudo leer la página " + std::to_string(id) +
+                                 " del archivo de intercambio '" + spillPath + "'");
+    }
+    frame.page = std::move(*page);
+    frame.bytes = frame.page.memoryBytes();
+    residentBytes += frame.bytes;
+    return frame;
+}
+
+void BufferPool::evictIfNeeded(std::unique_lock<std::mutex>& lock)
+{
+    // Reloj: se avanza la manecilla dando una segunda oportunidad a las
+    // páginas referenciadas. Dos vueltas sin víctimas = todo está fijado.
+    // Las páginas que ya se están escribiendo cuentan como liberadas.
+    size_t scanned = 0;
+    while (residentBytes - writingBytes > budget && !frames.empty() && scanned < 2 * frames.size()) {
+        auto it = frames.upper_bound(clockHand);
+        if (it == frames.end()) it = frames.begin();
+        clockHand = it->first;
+        scanned++;
+
+        Frame& frame = it->second;
+        if (frame.pinCount > 0 || frame.loading) continue;
+        if (frame.referenced) {
+            frame.referenced = false;
+            continue;
+        }
+        if (frame.dirty) {
+            if (!writeBack(lock, it->first)) {
+                // Sin copia en disco la página no se puede desalojar; las demás
+                // fallarían igual, así que se deja para la próxima pasada
+                break;
+            }
+        } else {
+            residentBytes -= frame.bytes;
+            frames.erase(it);
+            counters.evictions++;
+        }
+        scanned = 0;
+    }
+}
+
+bool BufferPool::openSpill()
+{
+    if (spillFd < 0) {
+        spillFd = ::open(spillPath.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    }
+    return spillFd >= 0;
+}
+
+bool BufferPool::fail(const std::string& message)
+{
+    counters.spillErrors++;
+    if (!spillFailing) pendingError = message;
+    spillFailing = true;
+    return false;
+}
+
+// Desaloja una página sucia: sale de 'frames' mientras se serializa y se
+// escribe sin el mutex. Si la escritura falla, vuelve sucia a 'frames'.
+bool BufferPool::writeBack(std::unique_lock<std::mutex>& lock, PageId id)
+{
+    if (!openSpill()) {
+        return fail("no se pudo abrir el archivo de intercambio '" + spillPath + "'");
+    }
+    auto node = frames.extract(id);
+    Frame& frame = node.mapped();
+    writing[id] = frame.bytes;
+    writingBytes += frame.bytes;
+    lock.unlock();
+
+    std::string data = frame.page.serialize();
+
+    // Se reutiliza el hueco anterior de la página si la nueva versión cabe.
+    // El hueco solo se registra si la escritura termina bien.
+    lock.lock();
+    DiskSlot slot;
+    auto slotIt = disk.find(id);
+    if (slotIt != disk.end()) slot = slotIt->second;
+    if (slot.capacity < data.size()) {
+        slot.offset = spillEnd;
+        slot.capacity = data.size();
+        spillEnd += data.size();
+    }
+    slot.size = data.size();
+    int fd = spillFd;
+    lock.unlock();
+
+    bool written = writeFully(fd, data.data(), data.size(), slot.offset);
+
+    lock.lock();
+    writing.erase(id);
+    writingBytes -= frame.bytes;
+    frameCv.notify_all();
+    if (!written) {
+        frames.insert(std::move(node));
+        return fail("no se pudo escribir la página " + std::to_string(id) +
+                    " en el archivo de intercambio '" + spillPath + "'");
+    }
+    disk[id] = slot;
+    spillFailing = false;
+    residentBytes -= frame.bytes;
+    counters.evictions++;
+    counters.writeBacks++;
+    return true;
+}
+
+void BufferPool::readAheadLoop()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        readAheadCv.wait(lock, [this] { return stopping || !readAheadQueue.empty(); });
+        if (stopping) return;
+
+        PageId id = readAheadQueue.front();
+        readAheadQueue.pop_front();
+        if (frames.count(id) || isBusy(id) || !disk.count(id)) continue;
+
+        try {
+            load(lock, id, true);
+        } catch (const std::exception& e) {
+            continue; // El pin de la sentencia volverá a intentarlo e informará el error
+        }
+        evictIfNeeded(lock);
+    }
+}
@@ -0,0 +1,265 @@
+#include "MiniDB/ColumnPage.hpp"
+#include <cstring>
+
+std::optional<CellValue> ColumnVector::get(size_t row) const
+{
+    if (!isValid(row)) return std::nullopt;
+    switch (type) {
+        case DataType::SMALLINT: return CellValue(smallints[row]);
+        case DataType::INTEGER: return CellValue(ints[row]);
+        case DataType::BIGINT: return CellValue(bigints[row]);
+        case DataType::DOUBLE: return CellValue(doubles[row]);
+        case DataType::BOOLEAN: return CellValue(bools[row] != 0);
+        case DataType::TEXT: return CellValue(texts[row]);
+    }
+    return std::nullopt;
+}
+
+bool ColumnVector::set(size_t row, const std::optional<CellValue>& value)
+{
+    std::optional<CellValue> cell = value ? coerceCell(*value, type) : std::nullopt;
+    bool valid = cell.has_value();
+    if (valid) {
+        switch (type) {
+            case DataType::SMALLINT: smallints[row] = std::get<int16_t>(*cell); break;
+            case DataType::INTEGER: ints[row] = std::get<int>(*cell); break;
+            case DataType::BIGINT: bigints[row] = std::get<int64_t>(*cell); break;
+            case DataType::DOUBLE: doubles[row] = std::get<double>(*cell); break;
+            case DataType::BOOLEAN: bools[row] = std::get<bool>(*cell); break;
+            case DataType::TEXT: texts[row] = std::move(std::get<std::string>(*cell)); break;
+        }
+    }
+
+    uint64_t bit = uint64_t(1) << (row % 64);
+    if (valid) {
+        validity[row / 64] |= bit;
+        return true;
+    }
+    // NULL: el valor del arreglo no se usa, se deja a cero
+    validity[row / 64] &= ~bit;
+    switch (type) {
+        case DataType::SMALLINT: smallints[row] = 0; break;
+        case DataType::INTEGER: ints[row] = 0; break;
+        case DataType::BIGINT: bigints[row] = 0; break;
+        case DataType::DOUBLE: doubles[row] = 0; break;
+        case DataType::BOOLEAN: bools[row] = 0; break;
+        case DataType::TEXT: texts[row].clear(); break;
+    }
+    return !value; // Un valor que no cabe no es un NULL pedido
+}
+
+ColumnPage::ColumnPage(const std::vector<Column>& schema)
+{
+    for (const auto& col : schema) {
+        ColumnVector column;
+        column.name = col.name;
+        column.type = col.type;
+        columns.push_back(std::move(column));
+    }
+}
+
+static void resizeColumn(ColumnVector& column, size_t rows)
+{
+    switch (column.type) {
+        case DataType::SMALLINT: column.smallints.resize(rows); break;
+        case DataType::INTEGER: column.ints.resize(rows); break;
+        case DataType::BIGINT: column.bigints.resize(rows); break;
+        case DataType::DOUBLE: column.doubles.resize(rows); break;
+        case DataType::BOOLEAN: column.bools.resize(rows); break;
+        case DataType::TEXT: column.texts.resize(rows); break;
+    }
+    column.validity.resize((rows + 63) / 64, 0);
+}
+
+void ColumnPage::resize(size_t rows)
+{
+    for (auto& column : columns) {
+        resizeColumn(column, rows);
+    }
+}
+
+void ColumnPage::append(const Row& row)
+{
+    resize(rowCount + 1);
+    for (auto& column : columns) {
+        auto it = row.find(column.name);
+        column.set(rowCount, it != row.end() ? std::optional<CellValue>(it->second) : std::nullopt);
+    }
+    rowCount++;
+}
+
+Row ColumnPage::row(size_t index) const
+{
+    Row result;
+    for (const auto& column : columns) {
+        if (auto value = column.get(index)) {
+            result.emplace(column.name, std::move(*value));
+        }
+    }
+    return result;
+}
+
+template <typename T>
+static void retainValues(std::vector<T>& values, const std::vector<size_t>& keep)
+{
+    for (size_t out = 0; out < keep.size(); ++out) {
+        if (keep[out] != out) values[out] = std::move(values[keep[out]]);
+    }
+    values.resize(keep.size());
+}
+
+void ColumnPage::retain(const std::vector<size_t>& keep)
+{
+    for (auto& column : columns) {
+        switch (column.type) {
+            case DataType::SMALLINT: retainValues(column.smallints, keep); break;
+            case DataType::INTEGER: retainValues(column.ints, keep); break;
+            case DataType::BIGINT: retainValues(column.bigints, keep); break;
+            case DataType::DOUBLE: retainValues(column.doubles, keep); break;
+            case DataType::BOOLEAN: retainValues(column.bools, keep); break;
+            case DataType::TEXT: retainValues(column.texts, keep); break;
+        }
+        std::vector<uint64_t> validity((keep.size() + 63) / 64, 0);
+        for (size_t out = 0; out < keep.size(); ++out) {
+            if (column.isValid(keep[out])) validity[out / 64] |= uint64_t(1) << (out % 64);
+        }
+        column.validity = std::move(validity);
+    }
+    rowCount = keep.size();
+}
+
+static size_t stringHeapBytes(const std::string& s)
+{
+    return s.capacity() > 15 ? s.capacity() + 1 : 0; // Cadenas cortas usan SSO
+}
+
+size_t ColumnPage::memoryBytes() const
+{
+    size_t bytes = sizeof(ColumnPage) + columns.capacity() * sizeof(ColumnVector);
+    for (const auto& column : columns) {
+        bytes += stringHeapBytes(column.name);
+        bytes += column.smallints.capacity() * sizeof(int16_t) + column.ints.capacity() * sizeof(int32_t)
+               + column.bigints.capacity() * sizeof(int64_t) + column.doubles.capacity() * sizeof(double)
+               + column.bools.capacity() + column.validity.capacity() * sizeof(uint64_t)
+               + column.texts.capacity() * sizeof(std::string);
+        for (const auto& text : column.texts) {
+            bytes += stringHeapBytes(text);
+        }
+    }
+    return bytes;
+}
+
+// Formato binario: filas y columnas; por columna su nombre, tipo, bitmap de
+// validez y el arreglo de valores tal cual está en memoria.
+static void writeU32(std::string& out, uint32_t value)
+{
+    out.append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+static void writeString(std::string& out, const std::string& s)
+{
+    writeU32(out, static_cast<uint32_t>(s.size()));
+    out += s;
+}
+
+template <typename T>
+static void writeArray(std::string& out, const std::vector<T>& values)
+{
+    out.append(reinterpret_cast<const char*>(values.data()), values.size() * sizeof(T));
+}
+
+std::string ColumnPage::serialize() const
+{
+    std::string out;
+    writeU32(out, static_cast<uint32_t>(rowCount));
+    writeU32(out, static_cast<uint32_t>(columns.size()));
+    for (const auto& column : columns) {
+        writeString(out, column.name);
+        out += static_cast<char>(column.type);
+        writeArray(out, column.validity);
+        switch (column.type) {
+            case DataType::SMALLINT: writeArray(out, column.smallints); break;
+            case DataType::INTEGER: writeArray(out, column.ints); break;
+            case DataType::BIGINT: writeArray(out, column.bigints); break;
+            case DataType::DOUBLE: writeArray(out, column.doubles); break;
+            case DataType::BOOLEAN: writeArray(out, column.bools); break;
+            case DataType::TEXT:
+                for (const auto& text : column.texts) writeString(out, text);
+                break;
+        }
+    }
+    return out;
+}
+
+// Bytes mínimos que ocupan 'rows' valores de una columna (texto: su longitud)
+static size_t minimumColumnBytes(DataType type, size_t rows)
+{
+    size_t width = 0;
+    switch (type) {
+        case DataType::SMALLINT: width = sizeof(int16_t); break;
+        case DataType::INTEGER: width = sizeof(int32_t); break;
+        case DataType::BIGINT: width = sizeof(int64_t); break;
+        case DataType::DOUBLE: width = sizeof(double); break;
+        case DataType::BOOLEAN: width = sizeof(uint8_t); break;
+        case DataType::TEXT: width = sizeof(uint32_t); break;
+    }
+    return (rows + 63) / 64 * sizeof(uint64_t) + rows * width;
+}
+
+std::optional<ColumnPage> ColumnPage::deserialize(const std::string& data)
+{
+    // Cada lectura comprueba antes que queden bytes suficientes
+    size_t pos = 0;
+    auto remaining = [&]() { return data.size() - pos; };
+    auto readU32 = [&](uint32_t& value) {
+        if (remaining() < sizeof(value)) return false;
+        data.copy(reinterpret_cast<char*>(&value), sizeof(value), pos);
+        pos += sizeof(value);
+        return true;
+    };
+    auto readString = [&](std::string& s) {
+        uint32_t len;
+        if (!readU32(len) || remaining() < len) return false;
+        s = data.substr(pos, len);
+        pos += len;
+        return true;
+    };
+    auto readArray = [&](auto& values) {
+        size_t bytes = values.size() * sizeof(values[0]);
+        if (remaining() < bytes) return false;
+        std::memcpy(values.data(), data.data() + pos, bytes);
+        pos += bytes;
+        return true;
+    };
+
+    ColumnPage page;
+    uint32_t rows, columnCount;
+    if (!readU32(rows) || !readU32(columnCount)) return std::nullopt;
+    page.rowCount = rows;
+    for (uint32_t c = 0; c < columnCount; ++c) {
+        ColumnVector column;
+        if (!readString(column.name) || remaining() < 1) return std::nullopt;
+        uint8_t type = static_cast<uint8_t>(data[pos++]);
+        if (type > static_cast<uint8_t>(DataType::BOOLEAN)) return std::nullopt;
+        column.type = static_cast<DataType>(type);
+        // Un número de filas dañado no debe reservar más de lo que hay en el buffer
+        if (remaining() < minimumColumnBytes(column.type, rows)) return std::nullopt;
+        resizeColumn(column, rows); // Los arreglos se dimensionan antes de leerlos
+
+        bool ok = readArray(column.validity);
+        switch (column.type) {
+            case DataType::SMALLINT: ok = ok && readArray(column.smallints); break;
+            case DataType::INTEGER: ok = ok && readArray(column.ints); break;
+            case DataType::BIGINT: ok = ok && readArray(column.bigints); break;
+            case DataType::DOUBLE: ok = ok && readArray(column.doubles); break;
+            case DataType::BOOLEAN: ok = ok && readArray(column.bools); break;
+            case DataType::TEXT:
+                for (auto& text : column.texts) ok = ok && readString(text);
+                break;
+        }
+        if (!ok) return std::nullopt;
+        page.columns.push_back(std::move(column));
+    }
+    if (pos != data.size()) return std::nullopt;
+    return page;
+}
@@ -6,18 +6,150 @@
 #include <sstream>
 #include <algorithm>
 #include <iomanip>
+#include <limits>
+#include "MiniDB/Planner.hpp"
+#include "MiniDB/Partition.hpp"
+#include <cstdio>
+#include <filesystem>
+#include <functional>
+#include <fcntl.h>
+#include <unistd.h>
 
-// El constructor carga la base de datos al ser creado
-Database::Database(const std::string &name) : db_name(name)
+// Sentencias que pueden esperar en el planificador antes de que submit() se bloquee
+constexpr size_t MAX_QUEUED_STATEMENTS = 1024;
+
+// Hilos auxiliares para recorrer particiones a la vez, entre todas las sentencias
+static const size_t MAX_SCAN_THREADS = std::max(1u, std::thread::hardware_concurrency());
+
+// Cada cuánto revisa el compactador los bloques aunque no haya habido DELETE
+constexpr std::chrono::seconds COMPACTION_POLL_INTERVAL{5};
+
+// Celda NULL en las filas CSV de un segmento. Las barras de los TEXT se
+// duplican al escribir, así que un texto "\N" nunca se confunde con ella.
+constexpr const char* NULL_MARKER = "\\N";
+
+static std::string escapeText(const std::string& text)
+{
+    std::string escaped;
+    for (char c : text) {
+        if (c == '\\') escaped += '\\';
+        escaped += c;
+    }
+    return escaped;
+}
+
+static std::string unescapeText(const std::string& text)
+{
+    std::string plain;
+    for (size_t i = 0; i < text.size(); ++i) {
+        if (text[i] == '\\' && i + 1 < text.size() && text[i + 1] == '\\') ++i;
+        plain += text[i];
+    }
+    return plain;
+}
+
+// Tipo de acceso de cada sentencia: decide qué bloqueos toma y qué puede
+// correr en paralelo en el planificador
+static AccessMode accessMode(const Command& command)
+{
+    switch (command.type) {
+        case CommandType::SELECT:
+            return AccessMode::READ;
+        case CommandType::INSERT:
+        case CommandType::UPDATE:
+        case CommandType::DELETE:
+        case CommandType::CREATE_INDEX:
+            return AccessMode::WRITE;
+        case CommandType::ANALYZE:
+            return command.tableName.empty() ? AccessMode::EXCLUSIVE : AccessMode::WRITE;
+        default:
+            return AccessMode::EXCLUSIVE;
+    }
+}
+
+// Sentencias que cambian datos o esquema: las únicas que van al log de
+// replicación. También se registran las que fallan; en la réplica fallan igual.
+static bool isReplicated(const Command& command)
+{
+    switch (command.type) {
+        case CommandType::CREATE_TABLE:
+        case CommandType::CREATE_INDEX:
+        case CommandType::INSERT:
+            return true;
+        case CommandType::UPDATE:
+        case CommandType::DELETE:
+            return !command.explain;
+        default:
+            return false;
+    }
+}
+
+// Archivo de intercambio del buffer pool. Una réplica trabaja en el directorio
+// de su primario, así que usa uno propio por proceso.
+static std::string bufferPoolPath(const std::string& name, ReplicationRole role)
 {
-    // Ahora 'name' es un nombre de archivo, no un directorio.
+    if (role == ReplicationRole::FOLLOWER) {
+        return name + ".replica." + std::to_string(getpid()) + ".pool";
+    }
+    return name + ".pool";
+}
+
+// El constructor carga el catálogo de la base de datos al ser creado
+Database::Database(const std::string &name, size_t memoryBudget, bool prefetchTables, ReplicationRole role)
+    : db_name(name), bufferPool(std::make_shared<BufferPool>(memoryBudget, bufferPoolPath(name, role))),
+      replicationRole(role), logReader(replicationLogPath(name))
+{
+    if (role == ReplicationRole::FOLLOWER) {
+        // Sin checkpoints: el catálogo y los segmentos son del primario
+        replicaSynced = resync();
+        if (!replicaSynced) {
+            std::cout << "Aviso: Aún no hay un checkpoint del primario con log de replicación; se reintentará.\n";
+        }
+        replicationThread = std::thread(&Database::replicationLoop, this);
+        compactionThread = std::thread(&Database::compactionLoop, this);
+        return;
+    }
+
+    // 'name' es el archivo de catálogo; las filas van en segmentos dentro de '<name>.d'.
     load();
+    if (role == ReplicationRole::PRIMARY &&
+        !replicationLog.open(replicationLogPath(db_name), currentTimeMillis(), catalogLsn)) {
+        std::cout << "Aviso: No se pudo crear el log de replicación '" << replicationLogPath(db_name) << "'.\n";
+    }
+    checkpointThread = std::thread(&Database::checkpointLoop, this);
+    compactionThread = std::thread(&Database::compactionLoop, this);
+    if (prefetchTables) {
+        prefetchThread = std::thread(&Database::prefetchLoop, this);
+    }
 }
 
-// El destructor guarda la base de datos antes de que el objeto se destruya
+// El destructor detiene los hilos de fondo y hace un checkpoint final
 Database::~Database()
 {
-    save();
+    scheduler.reset(); // Termina las sentencias encoladas
+    replicationStopping = true;
+    if (replicationThread.joinable()) {
+        replicationThread.join();
+    }
+    prefetchStopping = true;
+    if (prefetchThread.joinable()) {
+        prefetchThread.join();
+    }
+    {
+        std::lock_guard<std::mutex> lock(compactionSignalMutex);
+        compactionStopping = true;
+    }
+    compactionCv.notify_one();
+    compactionThread.join();
+    {
+        std::lock_guard<std::mutex> lock(checkpointSignalMutex);
+        stopping = true;
+    }
+    checkpointCv.notify_one();
+    if (checkpointThread.joinable()) {
+        checkpointThread.join();
+    }
+    checkpoint();
 }
 
 bool Database::createTable(const std::string& tableName, const std::vector<Column>& columns)
@@ -25,7 +157,9 @@ bool Database::createTable(const std::string& tableName, const std::vector<Colum
     if (tables.find(tableName) != tables.end()) {
         return false; // La tabla ya existe
     }
-    tables.emplace(tableName, Table(columns));
+    tables.emplace(std::piecewise_construct, std::forward_as_tuple(tableName),
+                   std::forward_as_tuple(columns, bufferPool));
+    tableLocks[tableName] = std::make_unique<std::shared_mutex>();
     return true;
 }
 
@@ -39,46 +173,316 @@ bool Database::insertInto(const std::string& tableName, const Row& row)
     return true;
 }
 
-std::optional<Table> Database::selectFrom(const std::string& tableName)
+// En una tabla particionada devuelve su primera partición (mismas columnas)
+const Table* Database::selectFrom(const std::string& tableName)
+{
+    std::ostringstream ignored; // La sentencia que use la tabla informará el error
+    ensureLoaded(tableName, ignored);
+    std::shared_lock<std::shared_mutex> stateLock(stateMutex);
+    return schemaTable(tableName);
+}
+
+Table* Database::getTable(const std::string& tableName)
 {
     auto it = tables.find(tableName);
-    if (it != tables.end()) {
-        return it->second;
+    return it != tables.end() ? &it->second : nullptr;
+}
+
+// Si de la tabla solo se leyó su entrada de catálogo, carga su segmento.
+// El archivo se lee en una tabla aparte sin ningún bloqueo; sus bloques se
+// publican al final con el bloqueo exclusivo de la tabla. Si no se puede
+// leer, la tabla sigue sin cargar y la próxima sentencia lo vuelve a intentar.
+bool Database::ensureLoaded(const std::string& tableName, std::ostream& out)
+{
+    SegmentState segment;
+    {
+        // Si otro hilo la está leyendo, se espera a que termine
+        std::unique_lock<std::mutex> segmentsLock(segmentsMutex);
+        segmentsCv.wait(segmentsLock, [&] { return !loadingTables.count(tableName); });
+        if (!unloadedTables.count(tableName)) return true;
+        segment = segments.at(tableName);
+        loadingTables.insert(tableName);
+    }
+
+    std::vector<Column> columns;
+    {
+        std::shared_lock<std::shared_mutex> stateLock(stateMutex);
+        auto tableIt = tables.find(tableName);
+        if (tableIt != tables.end()) columns = tableIt->second.getColumns();
+    }
+
+    bool loaded = true;
+    if (!columns.empty()) {
+        Table staged(columns, bufferPool); // Sus páginas se liberan si no se publican
+        loaded = readSegment(db_name + ".d/" + segment.file, segment.bytes, staged, out);
+
+        std::shared_lock<std::shared_mutex> stateLock(stateMutex);
+        auto tableIt = tables.find(tableName);
+        auto lockIt = tableLocks.find(tableName);
+        bool current = false;
+        {
+            // La tabla no se reemplazó (resync) mientras se leía el archivo
+            std::lock_guard<std::mutex> segmentsLock(segmentsMutex);
+            auto stateIt = segments.find(tableName);
+            current = unloadedTables.count(tableName) && stateIt != segments.end() &&
+                      stateIt->second.file == segment.file;
+        }
+        if (loaded && current && tableIt != tables.end() && lockIt != tableLocks.end()) {
+            std::unique_lock<std::shared_mutex> tableLock(*lockIt->second);
+            tableIt->second.appendBlocks(staged);
+            // Lo cargado coincide con el segmento en disco
+            std::lock_guard<std::mutex> segmentsLock(segmentsMutex);
+            segments[tableName].version = tableIt->second.getVersion();
+            unloadedTables.erase(tableName);
+        }
+    }
+
+    {
+        std::lock_guard<std::mutex> segmentsLock(segmentsMutex);
+        loadingTables.erase(tableName);
     }
-    return std::nullopt;
+    segmentsCv.notify_all();
+    return loaded;
 }
 
-bool checkCondition(const Row& row, const WhereClause& wc) {
-    auto it = row.find(wc.column);
-    if (it == row.end()) {
-        return false; // La columna no existe en la fila
+// Las lecturas y escrituras cargan sus tablas; ANALYZE sin tabla, todas
+std::vector<std::string> Database::tablesToLoad(const Command& command) const
+{
+    switch (accessMode(command)) {
+        case AccessMode::READ:
+        case AccessMode::WRITE:
+            return targetTables(command);
+        default:
+            break;
+    }
+    std::vector<std::string> names;
+    if (command.type == CommandType::ANALYZE) {
+        for (const auto& pair : tables) names.push_back(pair.first);
     }
+    return names;
+}
 
+bool Database::isUnloaded(const std::vector<std::string>& tableNames)
+{
+    std::lock_guard<std::mutex> segmentsLock(segmentsMutex);
+    return std::any_of(tableNames.begin(), tableNames.end(),
+                       [&](const std::string& name) { return unloadedTables.count(name) > 0; });
+}
+
+size_t Database::reserveScanThreads(size_t wanted)
+{
+    size_t current = scanThreads.load();
+    size_t granted = 0;
+    do {
+        granted = std::min(wanted, MAX_SCAN_THREADS - std::min(current, MAX_SCAN_THREADS));
+    } while (granted > 0 && !scanThreads.compare_exchange_weak(current, current + granted));
+    return granted;
+}
+
+void Database::forEachTarget(size_t count, const std::function<void(size_t)>& work)
+{
+    std::atomic<size_t> nextTarget{0};
+    auto runTargets = [&] {
+        for (size_t i = nextTarget++; i < count; i = nextTarget++) work(i);
+    };
+    size_t helpers = count > 1 ? reserveScanThreads(count - 1) : 0;
+    std::vector<std::future<void>> runs;
+    for (size_t i = 0; i < helpers; ++i) {
+        runs.push_back(std::async(std::launch::async, runTargets));
+    }
+    std::exception_ptr error;
     try {
-        // Si la celda es INTEGER, comparamos numéricamente
-        if (std::holds_alternative<int>(it->second)) {
-            int cellValue = std::get<int>(it->second);
-            int conditionValue = std::stoi(wc.value);
-            if (wc.op == "=") return cellValue == conditionValue;
-            if (wc.op == ">") return cellValue > conditionValue;
-            if (wc.op == "<") return cellValue < conditionValue;
-            if (wc.op == ">=") return cellValue >= conditionValue;
-            if (wc.op == "<=") return cellValue <= conditionValue;
-            if (wc.op == "!=") return cellValue != conditionValue;
-        } else { // Si es TEXT, solo comparamos por igualdad/desigualdad
-            std::string cellValue = std::get<std::string>(it->second);
-            if (wc.op == "=") return cellValue == wc.value;
-            if (wc.op == "!=") return cellValue != wc.value;
-        }
-    } catch (const std::invalid_argument& e) {
-        // El valor de la condición no es un número para una comparación numérica
-        return false;
-    } catch (const std::out_of_range& e) {
+        runTargets();
+    } catch (...) {
+        error = std::current_exception();
+    }
+    for (auto& run : runs) {
+        try {
+            run.get();
+        } catch (...) {
+            if (!error) error = std::current_exception();
+        }
+    }
+    scanThreads -= helpers;
+    if (error) std::rethrow_exception(error);
+}
+
+// Carga en segundo plano las tablas que aún no se han usado
+void Database::prefetchLoop()
+{
+    std::vector<std::string> pending;
+    {
+        std::lock_guard<std::mutex> segmentsLock(segmentsMutex);
+        pending.assign(unloadedTables.begin(), unloadedTables.end());
+    }
+    std::ostringstream ignored; // La sentencia que use la tabla informará el error
+    for (const auto& tableName : pending) {
+        if (prefetchStopping) return;
+        ensureLoaded(tableName, ignored);
+    }
+}
+
+// Réplica: carga la foto del último checkpoint del primario y se sitúa en su
+// log justo después. Falla (y se reintenta) si el primario aún no tiene log o
+// si hace un checkpoint o reinicia mientras tanto.
+bool Database::resync()
+{
+    auto readCatalog = [this] {
+        std::ifstream file(db_name, std::ios::binary);
+        return std::string(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    };
+    std::string catalog = readCatalog();
+    size_t marker = catalog.find("[REPLICATION:");
+    if (marker == std::string::npos) return false;
+    int64_t epoch = 0;
+    uint64_t lsn = 0;
+    std::istringstream(catalog.substr(marker + 13)) >> epoch >> lsn;
+
+    // El log debe empezar como muy tarde en el LSN de la foto. Si es de un
+    // primario reiniciado, debe partir exactamente de ella.
+    auto header = logReader.open();
+    if (!header || header->startLsn > lsn || (header->epoch != epoch && header->startLsn != lsn)) {
         return false;
     }
 
-    return false; // Operador no soportado para el tipo de dato
+    {
+        std::unique_lock<std::shared_mutex> stateLock(stateMutex);
+        tables.clear();
+        tableLocks.clear();
+        partitionSchemes.clear();
+        {
+            std::lock_guard<std::mutex> segmentsLock(segmentsMutex);
+            segments.clear();
+            unloadedTables.clear();
+        }
+        resultCache.clear(); // Las versiones de las tablas vuelven a empezar
+
+        std::istringstream catalogStream(catalog);
+        loadCatalog(catalogStream);
+    }
+    // Los segmentos se leen ya, fuera del bloqueo: el primario borra los que reemplaza
+    std::vector<std::string> pending;
+    {
+        std::lock_guard<std::mutex> segmentsLock(segmentsMutex);
+        pending.assign(unloadedTables.begin(), unloadedTables.end());
+    }
+    std::ostringstream ignored;
+    for (const auto& tableName : pending) {
+        if (!ensureLoaded(tableName, ignored)) return false;
+    }
+    if (readCatalog() != catalog) {
+        return false; // Un checkpoint reemplazó segmentos mientras se leían
+    }
+
+    appliedLsn = lsn;
+    receivedLsn = lsn;
+    replicaEpoch = header->epoch;
+    resyncCount++;
+    return true;
+}
+
+// Réplica: lee los registros nuevos del log y los aplica en orden
+void Database::replicationLoop()
+{
+    Parser parser;
+    while (!replicationStopping) {
+        if (!replicaSynced) {
+            replicaSynced = resync();
+            std::this_thread::sleep_for(REPLICATION_POLL_INTERVAL);
+            continue;
+        }
+
+        bool replaced = false;
+        auto records = logReader.poll(replaced);
+        if (!records.empty()) {
+            receivedLsn = std::max<uint64_t>(receivedLsn, records.back().lsn);
+        }
+        for (const auto& record : records) {
+            if (record.lsn <= appliedLsn) continue; // Ya incluido en la foto
+            if (record.lsn != appliedLsn + 1) {
+                replicaSynced = false; // Hueco en el log: volver a empezar desde un checkpoint
+                break;
+            }
+            std::ostringstream discarded;
+            applyStatement(parser.parse(record.sql), discarded);
+            appliedLsn = record.lsn;
+            replicationLagMs = currentTimeMillis() - record.timestampMs;
+        }
+        if (!replicaSynced) continue;
+
+        if (replaced) {
+            // Mismo primario (checkpoint): el log nuevo continúa el anterior.
+            // Primario reiniciado: sirve solo si no se aplicó nada que perdió.
+            auto header = logReader.open();
+            bool continues = header && (header->epoch == replicaEpoch ? header->startLsn <= appliedLsn
+                                                                      : header->startLsn == appliedLsn);
+            if (continues) {
+                replicaEpoch = header->epoch;
+            } else {
+                replicaSynced = false;
+            }
+        } else if (records.empty()) {
+            std::this_thread::sleep_for(REPLICATION_POLL_INTERVAL);
+        }
+    }
+}
+
+// Encola una sentencia en el planificador, que se crea con el primer uso
+void Database::schedule(const Command& command, Scheduler::Job job, Scheduler::Job then)
+{
+    std::call_once(schedulerOnce, [this] {
+        size_t workers = std::max(2u, std::thread::hardware_concurrency());
+        scheduler = std::make_unique<Scheduler>(workers, MAX_QUEUED_STATEMENTS);
+    });
+    scheduler->enqueue(command.tableName, accessMode(command), std::move(job), std::move(then));
+}
+
+std::future<std::string> Database::submit(Command command)
+{
+    auto promise = std::make_shared<std::promise<std::string>>();
+    auto future = promise->get_future();
+    auto shared = std::make_shared<Command>(std::move(command));
+    schedule(*shared, [this, shared, promise] {
+        try {
+            std::ostringstream out;
+            execute(*shared, out);
+            promise->set_value(out.str());
+        } catch (...) {
+            promise->set_exception(std::current_exception());
+        }
+    });
+    return future;
+}
+
+#ifdef MINIDB_COROUTINES
+Database::StatementAwaiter::StatementAwaiter(Database& database, Command cmd)
+    : db(database), command(std::move(cmd)) {}
+
+void Database::StatementAwaiter::await_suspend(std::coroutine_handle<> handle)
+{
+    // La corrutina se reanuda en el hilo del pool, ya liberada la tabla
+    db.schedule(command, [this] {
+        try {
+            std::ostringstream out;
+            db.execute(command, out);
+            output = out.str();
+        } catch (...) {
+            error = std::current_exception();
+        }
+    }, [handle] { handle.resume(); });
+}
+
+std::string Database::StatementAwaiter::await_resume()
+{
+    if (error) std::rethrow_exception(error);
+    return std::move(output);
+}
+
+Database::StatementAwaiter Database::executeAsync(Command command)
+{
+    return StatementAwaiter(*this, std::move(command));
 }
+#endif
 
 void Database::executeScript(const std::string& scriptContent) {
     Parser parser;
@@ -111,24 +515,425 @@ void Database::executeScript(const std::string& scriptContent) {
     }
 }
 
-void Database::execute(const Command& command) {
+// Asignación de UPDATE ya resuelta: tipo comprobado y literal convertido
+struct Assignment {
+    std::string column;
+    size_t columnIndex = 0;
+    std::optional<CellValue> literal; // nullopt = NULL
+    size_t sourceIndex = 0;           // Solo si op != 0
+    char op = 0;
+};
+
+static bool compileAssignments(const std::vector<Column>& columns, const std::vector<SetClause>& setClauses,
+                               std::vector<Assignment>& assignments, std::ostream& out)
+{
+    auto findColumn = [&](const std::string& name) {
+        return std::find_if(columns.begin(), columns.end(), [&](const Column& c) { return c.name == name; });
+    };
+
+    for (const auto& setClause : setClauses) {
+        auto colIt = findColumn(setClause.column);
+        if (colIt == columns.end()) {
+            out << "Error: La columna '" << setClause.column << "' no existe en la tabla.\n";
+            return false;
+        }
+
+        Assignment assignment;
+        assignment.column = setClause.column;
+        assignment.columnIndex = colIt - columns.begin();
+        assignment.op = setClause.op;
+        // Tipo del literal: el de la columna, o el del operando de la aritmética
+        DataType literalType = colIt->type;
+        if (setClause.op != 0) {
+            auto sourceIt = findColumn(setClause.sourceColumn);
+            if (sourceIt == columns.end()) {
+                out << "Error: La columna '" << setClause.sourceColumn << "' no existe en la tabla.\n";
+                return false;
+            }
+            if (!isNumeric(colIt->type) || !isNumeric(sourceIt->type)) {
+                out << "Error: La aritmética solo se permite entre columnas numéricas.\n";
+                return false;
+            }
+            assignment.sourceIndex = sourceIt - columns.begin();
+            bool real = colIt->type == DataType::DOUBLE || sourceIt->type == DataType::DOUBLE;
+            literalType = real ? DataType::DOUBLE : DataType::BIGINT;
+        }
+
+        if (setClause.op == 0 && isNullLiteral(setClause.value)) {
+            assignment.literal = std::nullopt;
+        } else {
+            assignment.literal = parseCell(setClause.value, literalType);
+            if (!assignment.literal) {
+                out << "Error: Valor '" << setClause.value << "' no es válido para la columna '" << setClause.column
+                    << "' de tipo " << typeName(literalType) << ".\n";
+                return false;
+            }
+        }
+        if (assignment.op == '/' && numericValue(*assignment.literal) == 0.0) {
+            out << "Error: División por cero en la columna '" << setClause.column << "'.\n";
+            return false;
+        }
+        assignments.push_back(std::move(assignment));
+    }
+    return true;
+}
+
+// Un literal del WHERE que no es del tipo de su columna aborta la sentencia,
+// como en INSERT y UPDATE: "id < 3.5" sobre INTEGER no se trunca ni deja de
+// coincidir en silencio. Los enteros se comparan en 64 bits (rango de BIGINT).
+// Comparar con NULL es válido: nunca es TRUE ni FALSE.
+static bool checkWhereLiterals(const WhereExpr& expr, const std::vector<Column>& columns, std::ostream& out)
+{
+    if (expr.type != ExprType::PREDICATE) {
+        return std::all_of(expr.children.begin(), expr.children.end(),
+                           [&](const WhereExpr& child) { return checkWhereLiterals(child, columns, out); });
+    }
+    const auto& wc = expr.predicate;
+    if (wc.op == "IS NULL" || wc.op == "IS NOT NULL" || isNullLiteral(wc.value)) return true;
+    auto colIt = std::find_if(columns.begin(), columns.end(), [&](const Column& c) { return c.name == wc.column; });
+    if (colIt == columns.end()) return true; // Columna desconocida: no coincide ninguna fila
+    DataType literalType = isIntegral(colIt->type) ? DataType::BIGINT : colIt->type;
+    if (!parseCell(wc.value, literalType)) {
+        out << "Error: Valor '" << wc.value << "' no es válido para la columna '" << wc.column
+            << "' de tipo " << typeName(colIt->type) << ".\n";
+        return false;
+    }
+    return true;
+}
+
+// Resultado de 'valor op operando'; nullopt si una operación entera se sale
+// de 64 bits. Que quepa en una columna más estrecha lo comprueba findOverflow.
+static std::optional<CellValue> applyArithmetic(const CellValue& value, char op, const CellValue& operand)
+{
+    if (std::holds_alternative<double>(value) || std::holds_alternative<double>(operand)) {
+        double a = *numericValue(value), b = *numericValue(operand);
+        switch (op) {
+            case '+': return a + b;
+            case '-': return a - b;
+            case '*': return a * b;
+            case '/': return a / b;
+        }
+        return a;
+    }
+    // Entre enteros se calcula en 64 bits (el divisor nunca es 0: se rechaza al compilar)
+    int64_t a = *integralValue(value), b = *integralValue(operand);
+    int64_t result = a;
+    bool overflow = false;
+    switch (op) {
+        case '+': overflow = __builtin_add_overflow(a, b, &result); break;
+        case '-': overflow = __builtin_sub_overflow(a, b, &result); break;
+        case '*': overflow = __builtin_mul_overflow(a, b, &result); break;
+        case '/':
+            overflow = a == std::numeric_limits<int64_t>::min() && b == -1;
+            if (!overflow) result = a / b;
+            break;
+    }
+    if (overflow) return std::nullopt;
+    return CellValue(result);
+}
+
+// Valor que una asignación aritmética guarda para un valor de su columna
+// origen, ya convertido al tipo destino; nullopt si no cabe
+static std::optional<CellValue> assignedValue(const Assignment& assignment, const CellValue& source, DataType targetType)
+{
+    auto result = applyArithmetic(source, assignment.op, *assignment.literal);
+    return result ? coerceCell(*result, targetType) : std::nullopt;
+}
+
+// Primera asignación aritmética cuyo resultado no cabe en su columna entera
+// para alguna fila seleccionada, o nullptr. Se comprueba antes de escribir para
+// que la sentencia falle entera. Sumar, restar, multiplicar o dividir por un
+// literal es monótono: si el resultado cabe para el mínimo y el máximo del
+// zone map de un bloque, cabe para todo el bloque y no hace falta leerlo.
+static const Assignment* findOverflow(const Table& table, const std::vector<Assignment>& assignments,
+                                      const BlockFilter& blockFilter, const RowSelector& selector,
+                                      const CandidateMap* candidates)
+{
+    const auto& columns = table.getColumns();
+    std::vector<const Assignment*> arithmetic;
+    for (const auto& assignment : assignments) {
+        if (assignment.op != 0 && isIntegral(columns[assignment.columnIndex].type)) arithmetic.push_back(&assignment);
+    }
+
+    auto fitsByZones = [&](const RowBlock& block) {
+        for (const auto* assignment : arithmetic) {
+            auto zoneIt = block.zones.find(columns[assignment->sourceIndex].name);
+            if (zoneIt == block.zones.end()) return false; // Origen DOUBLE: sin zone maps
+            if (!zoneIt->second.hasValues) continue;      // Todo NULL: queda NULL
+            DataType targetType = columns[assignment->columnIndex].type;
+            if (!assignedValue(*assignment, zoneIt->second.min, targetType) ||
+                !assignedValue(*assignment, zoneIt->second.max, targetType)) {
+                return false;
+            }
+        }
+        return true;
+    };
+    auto needsCheck = [&](const RowBlock& block) {
+        return (!blockFilter || blockFilter(block)) && !fitsByZones(block);
+    };
+    const auto& blocks = table.getBlocks();
+    if (arithmetic.empty() || std::none_of(blocks.begin(), blocks.end(), needsCheck)) {
+        return nullptr;
+    }
+
+    // Solo se leen los bloques que los zone maps no descartan
+    const Assignment* overflow = nullptr;
+    table.scan(needsCheck, selector, [&](const Row& row) {
+        for (const auto* assignment : arithmetic) {
+            if (overflow) return;
+            auto cellIt = row.find(columns[assignment->sourceIndex].name);
+            if (cellIt == row.end()) continue; // NULL da NULL
+            if (!assignedValue(*assignment, cellIt->second, columns[assignment->columnIndex].type)) {
+                overflow = assignment;
+            }
+        }
+    }, candidates);
+    return overflow;
+}
+
+// Aplica las asignaciones a las filas seleccionadas de un bloque, columna por
+// columna. Las expresiones se evalúan primero para que todas lean los valores
+// anteriores a la sentencia (SET a = b + 1, b = 0 usa el b original).
+static void applyAssignments(const std::vector<Assignment>& assignments, ColumnPage& page,
+                             const std::vector<size_t>& selection)
+{
+    std::vector<std::vector<std::optional<CellValue>>> computed(assignments.size());
+    for (size_t a = 0; a < assignments.size(); ++a) {
+        const auto& assignment = assignments[a];
+        if (assignment.op == 0) continue;
+        const auto& source = page.column(assignment.sourceIndex);
+        auto& results = computed[a];
+        results.reserve(selection.size());
+        for (size_t i : selection) {
+            auto cell = source.get(i);
+            // NULL con cualquier operación da NULL
+            results.push_back(cell ? applyArithmetic(*cell, assignment.op, *assignment.literal) : std::nullopt);
+        }
+    }
+
+    for (size_t a = 0; a < assignments.size(); ++a) {
+        const auto& assignment = assignments[a];
+        auto& target = page.column(assignment.columnIndex);
+        // Los literales ya tienen el tipo de la columna y los resultados se
+        // comprobaron con findOverflow: todos caben
+        for (size_t k = 0; k < selection.size(); ++k) {
+            target.set(selection[k], assignment.op == 0 ? assignment.literal : computed[a][k]);
+        }
+    }
+}
+
+// Las lecturas y escrituras toman 'stateMutex' compartido y el bloqueo de su
+// tabla; el resto de las sentencias toma 'stateMutex' en exclusiva.
+void Database::execute(const Command& command, std::ostream& out)
+{
+    // Una réplica solo cambia al aplicar el log del primario
+    if (replicationRole == ReplicationRole::FOLLOWER &&
+        (isReplicated(command) || command.type == CommandType::CHECKPOINT)) {
+        out << "Error: Esta base de datos es una réplica de solo lectura.\n";
+        return;
+    }
+    applyStatement(command, out);
+}
+
+void Database::applyStatement(const Command& command, std::ostream& out)
+{
+    // Las particiones "tabla#n" son internas: ninguna sentencia las nombra
+    // directamente, ni siquiera para crearlas
+    if (command.tableName.find(PARTITION_SEPARATOR) != std::string::npos) {
+        out << "Error: El nombre de tabla no puede contener '" << PARTITION_SEPARATOR << "'.\n";
+        return;
+    }
+
+    AccessMode mode = accessMode(command);
+    while (true) {
+        // Las tablas sin cargar se leen antes de tomar los bloqueos; si no se
+        // pueden leer, la sentencia falla y no se registra
+        std::vector<std::string> pending;
+        {
+            std::shared_lock<std::shared_mutex> stateLock(stateMutex);
+            pending = tablesToLoad(command);
+        }
+        for (const auto& name : pending) {
+            if (!ensureLoaded(name, out)) return;
+        }
+
+        if (mode == AccessMode::EXCLUSIVE) {
+            std::unique_lock<std::shared_mutex> stateLock(stateMutex);
+            if (isUnloaded(tablesToLoad(command))) continue; // Un resync las volvió a descargar
+            runLocked(command, out);
+            return;
+        }
+
+        // Una tabla particionada bloquea solo las particiones que va a tocar,
+        // siempre en el mismo orden para evitar interbloqueos
+        std::shared_lock<std::shared_mutex> stateLock(stateMutex);
+        auto targets = targetTables(command);
+        if (isUnloaded(targets)) continue;
+        std::sort(targets.begin(), targets.end());
+        std::vector<std::shared_lock<std::shared_mutex>> readLocks;
+        std::vector<std::unique_lock<std::shared_mutex>> writeLocks;
+        for (const auto& name : targets) {
+            auto lockIt = tableLocks.find(name);
+            if (lockIt == tableLocks.end()) continue; // La tabla no existe: executeLocked informa el error
+            if (mode == AccessMode::READ) {
+                readLocks.emplace_back(*lockIt->second);
+            } else {
+                writeLocks.emplace_back(*lockIt->second);
+            }
+        }
+        runLocked(command, out);
+        return;
+    }
+}
+
+void Database::runLocked(const Command& command, std::ostream& out)
+{
+    try {
+        executeLocked(command, out);
+    } catch (const std::exception& e) {
+        // Una página del buffer pool no se pudo leer: la sentencia no se replica
+        out << "Error: " << e.what() << ".\n";
+        return;
+    }
+    logStatement(command, out);
+    if (auto error = bufferPool->takeError()) {
+        out << "Aviso: Buffer pool: " << *error << "; la página se mantiene en memoria.\n";
+    }
+}
+
+// Primario: copia la sentencia al log. Se llama con sus bloqueos aún tomados,
+// así el log conserva el orden en que se modificó cada tabla.
+void Database::logStatement(const Command& command, std::ostream& out)
+{
+    if (replicationRole != ReplicationRole::PRIMARY || !isReplicated(command)) return;
+    if (command.text.empty()) {
+        out << "Aviso: La sentencia no tiene texto SQL y no se replicará.\n";
+        return;
+    }
+    replicationLog.append(command.text);
+}
+
+// Tablas físicas que toca una sentencia: la propia tabla o, si está
+// particionada, las particiones que sobreviven a la poda
+std::vector<std::string> Database::targetTables(const Command& command) const
+{
+    auto schemeIt = partitionSchemes.find(command.tableName);
+    if (schemeIt == partitionSchemes.end()) {
+        return {command.tableName};
+    }
+    const auto& scheme = schemeIt->second;
+
+    std::vector<size_t> partitions;
+    if (command.type == CommandType::SELECT || command.type == CommandType::UPDATE || command.type == CommandType::DELETE) {
+        const auto& columns = tables.at(partitionName(command.tableName, 0)).getColumns();
+        auto colIt = std::find_if(columns.begin(), columns.end(), [&](const Column& c) { return c.name == scheme.column; });
+        partitions = prunePartitions(scheme, colIt->type, command.whereClause);
+    } else {
+        for (size_t i = 0; i < scheme.count; ++i) partitions.push_back(i);
+    }
+
+    std::vector<std::string> names;
+    for (size_t partition : partitions) {
+        names.push_back(partitionName(command.tableName, partition));
+    }
+    return names;
+}
+
+std::vector<std::pair<std::string, Table*>> Database::resolveTargets(const Command& command)
+{
+    std::vector<std::pair<std::string, Table*>> result;
+    for (const auto& name : targetTables(command)) {
+        if (Table* table = getTable(name)) result.emplace_back(name, table);
+    }
+    return result;
+}
+
+// Tabla que define las columnas: la propia tabla o su primera partición
+const Table* Database::schemaTable(const std::string& tableName)
+{
+    if (partitionSchemes.count(tableName)) {
+        return getTable(partitionName(tableName, 0));
+    }
+    return getTable(tableName);
+}
+
+// EXPLAIN: plan de cada tabla física y, si hay particiones, cuántas se leen
+void Database::explainTargets(const Command& command, const std::vector<std::pair<std::string, Table*>>& targets,
+                              std::ostream& out)
+{
+    for (const auto& target : targets) {
+        AccessPlan plan = choosePlan(*target.second, command.whereClause);
+        out << "Plan: " << describePlan(*target.second, target.first, plan) << "\n";
+    }
+    auto schemeIt = partitionSchemes.find(command.tableName);
+    if (schemeIt != partitionSchemes.end()) {
+        out << "Particiones: " << targets.size() << " de " << schemeIt->second.count << " tras la poda.\n";
+    }
+}
+
+void Database::executeLocked(const Command& command, std::ostream& out) {
     switch (command.type) {
         case CommandType::CREATE_TABLE: {
-            if (createTable(command.tableName, command.columns)) {
-                std::cout << "Tabla '" << command.tableName << "' creada.\n";
+            if (partitionSchemes.count(command.tableName) || tables.count(command.tableName)) {
+                out << "Error: La tabla '" << command.tableName << "' ya existe.\n";
+                return;
+            }
+            if (!command.partition) {
+                createTable(command.tableName, command.columns);
+                out << "Tabla '" << command.tableName << "' creada.\n";
+                return;
+            }
+
+            const auto& scheme = *command.partition;
+            auto colIt = std::find_if(command.columns.begin(), command.columns.end(),
+                                      [&](const Column& c) { return c.name == scheme.column; });
+            if (colIt == command.columns.end()) {
+                out << "Error: La columna de partición '" << scheme.column << "' no existe.\n";
+                return;
+            }
+            if (scheme.method == PartitionMethod::RANGE &&
+                (colIt->type != DataType::INTEGER || std::adjacent_find(scheme.bounds.begin(), scheme.bounds.end(),
+                                                                        std::greater_equal<int>()) != scheme.bounds.end())) {
+                out << "Error: PARTITION BY RANGE requiere una columna INTEGER y límites crecientes.\n";
+                return;
+            }
+            if (scheme.count == 0 || scheme.count > MAX_PARTITIONS) {
+                out << "Error: El número de particiones debe estar entre 1 y " << MAX_PARTITIONS << ".\n";
+                return;
+            }
+            for (size_t i = 0; i < scheme.count; ++i) {
+                createTable(partitionName(command.tableName, i), command.columns);
+            }
+            partitionSchemes[command.tableName] = scheme;
+            out << "Tabla '" << command.tableName << "' creada con " << scheme.count << " partición(es).\n";
+            break;
+        }
+        case CommandType::CREATE_INDEX: {
+            if (!schemaTable(command.tableName)) {
+                out << "Error: La tabla '" << command.tableName << "' no existe.\n";
+                return;
+            }
+            // En una tabla particionada cada partición tiene su propio índice
+            const auto& column = command.columnNames.front();
+            bool created = true;
+            for (const auto& target : resolveTargets(command)) {
+                created = target.second->createIndex(command.indexName, column) && created;
+            }
+            if (created) {
+                out << "Índice '" << command.indexName << "' creado sobre " << command.tableName << "(" << column << ").\n";
             } else {
-                std::cout << "Error: La tabla '" << command.tableName << "' ya existe.\n";
+                out << "Error: La columna '" << column << "' no existe o ya tiene un índice.\n";
             }
             break;
         }
         case CommandType::INSERT: {
-            auto tableOpt = selectFrom(command.tableName);
+            auto tableOpt = schemaTable(command.tableName);
             if (!tableOpt) {
-                std::cout << "Error: La tabla '" << command.tableName << "' no existe.\n";
+                out << "Error: La tabla '" << command.tableName << "' no existe.\n";
                 return;
             }
             if (tableOpt->getColumns().size() != command.values.size()) {
-                std::cout << "Error: El número de valores no coincide con el número de columnas.\n";
+                out << "Error: El número de valores no coincide con el número de columnas.\n";
                 return;
             }
 
@@ -136,38 +941,60 @@ void Database::execute(const Command& command) {
             for (size_t i = 0; i < command.values.size(); ++i) {
                 const auto& col = tableOpt->getColumns()[i];
                 const auto& valStr = command.values[i];
-                try {
-                    if (col.type == DataType::INTEGER) {
-                        newRow[col.name] = std::stoi(valStr);
-                    } else { // TEXT
-                        newRow[col.name] = valStr;
-                    }
-                } catch (const std::invalid_argument& e) {
-                    std::cout << "Error: Valor '" << valStr << "' no es válido para la columna '" << col.name << "' de tipo INTEGER.\n";
-                    return;
-                } catch (const std::out_of_range& e) {
-                    std::cout << "Error: Valor '" << valStr << "' fuera de rango para tipo INTEGER.\n";
+                if (isNullLiteral(valStr)) continue; // NULL: la celda queda sin valor
+                auto value = parseCell(valStr, col.type);
+                if (!value) {
+                    out << "Error: Valor '" << valStr << "' no es válido para la columna '" << col.name
+                        << "' de tipo " << typeName(col.type) << ".\n";
                     return;
                 }
+                newRow[col.name] = std::move(*value);
             }
 
-            // Re-chequeamos la tabla porque insertInto podría fallar por otras razones
-            auto it = tables.find(command.tableName);
-            if (it != tables.end() && it->second.insert(newRow)) {
-                std::cout << "Fila insertada.\n";
+            // En una tabla particionada la fila va a la partición de su clave
+            Table* target = getTable(command.tableName);
+            auto schemeIt = partitionSchemes.find(command.tableName);
+            if (schemeIt != partitionSchemes.end()) {
+                target = getTable(partitionName(command.tableName, partitionFor(schemeIt->second, newRow)));
+            }
+            if (target && target->insert(newRow)) {
+                out << "Fila insertada.\n";
             } else {
-                std::cout << "Error al insertar la fila.\n";
+                out << "Error al insertar la fila.\n";
             }
             break;
         }
         case CommandType::SELECT: {
-            auto tableOpt = selectFrom(command.tableName);
+            auto tableOpt = schemaTable(command.tableName);
             if (!tableOpt) {
-                std::cout << "Error: La tabla '" << command.tableName << "' no existe.\n";
+                out << "Error: La tabla '" << command.tableName << "' no existe.\n";
                 return;
             }
 
             const auto& table = *tableOpt;
+            if (command.whereClause && !checkWhereLiterals(*command.whereClause, table.getColumns(), out)) {
+                return;
+            }
+            auto targets = resolveTargets(command);
+            // Caché de resultados: válida mientras la versión de las tablas leídas no cambie.
+            // Las versiones solo crecen, así que su suma cambia con cualquier escritura.
+            uint64_t version = 0;
+            for (const auto& target : targets) {
+                version += target.second->getVersion();
+            }
+            std::string cacheKey;
+            if (resultCache.isEnabled() && !command.explain) {
+                cacheKey = resultCacheKey(command);
+                if (auto cached = resultCache.lookup(cacheKey, version)) {
+                    out << *cached;
+                    return;
+                }
+            }
+
+            if (command.explain) {
+                explainTargets(command, targets, out);
+                return;
+            }
             std::vector<std::string> colsToPrint;
 
             if (command.columnNames.size() == 1 && command.columnNames[0] == "*") {
@@ -178,229 +1005,875 @@ void Database::execute(const Command& command) {
 
             // --- Inicio de la nueva lógica de formato ---
 
-            // 1. Recopilar las filas que se van a imprimir y calcular anchos
-            std::vector<Row> rowsToPrint;
-            std::unordered_map<std::string, size_t> colWidths;
+            // 1. Recopilar las filas que se van a imprimir; cada partición se
+            // recorre con su propio plan y filtro, repartidas entre el hilo de la
+            // sentencia y los auxiliares que queden libres
+            std::vector<std::vector<Row>> partitionRows(targets.size());
+            auto scanTarget = [&](size_t index) {
+                const Table& source = *targets[index].second;
+                AccessPlan plan = choosePlan(source, command.whereClause);
+                std::optional<Filter> filter;
+                if (command.whereClause) {
+                    filter.emplace(*command.whereClause, source.getColumns(), command.tableName, predicateStats);
+                }
+                BlockFilter blockFilter = filter ? filter->blockFilter() : nullptr;
+                RowSelector selector = filter ? filter->selector() : nullptr;
+                auto candidates = fetchCandidates(source, plan);
+                source.scan(blockFilter, selector, [&](const Row& row) {
+                    partitionRows[index].push_back(row);
+                }, candidates ? &*candidates : nullptr);
+            };
+            forEachTarget(targets.size(), scanTarget);
 
-            // Inicializar anchos con la longitud de las cabeceras
+            // Calcular anchos, empezando por la longitud de las cabeceras
+            std::unordered_map<std::string, size_t> colWidths;
             for (const auto& colName : colsToPrint) {
                 colWidths[colName] = colName.length();
             }
-
-            for (const auto& row : table.getRows()) {
-                if (!command.whereClause || checkCondition(row, *command.whereClause)) {
-                    rowsToPrint.push_back(row);
+            for (const auto& rows : partitionRows) {
+                for (const auto& row : rows) {
                     // Actualizar anchos máximos con los valores de la fila
                     for (const auto& colName : colsToPrint) {
                         auto cellIt = row.find(colName);
-                        if (cellIt != row.end()) {
-                            std::string cellStr = std::visit([](auto&& arg) {
-                                // Usar un ostringstream para convertir cualquier tipo a string
-                                std::ostringstream oss;
-                                oss << arg;
-                                return oss.str();
-                            }, cellIt->second);
-                            if (cellStr.length() > colWidths[colName]) {
-                                colWidths[colName] = cellStr.length();
-                            }
+                        std::string cellStr = cellIt != row.end() ? formatCell(cellIt->second) : "NULL";
+                        if (cellStr.length() > colWidths[colName]) {
+                            colWidths[colName] = cellStr.length();
                         }
                     }
                 }
             }
 
-            // 2. Imprimir la cabecera formateada
-            std::cout << "| ";
+            // 2. Imprimir la cabecera formateada (en un buffer, para poder guardarlo en la caché)
+            std::ostringstream result;
+            result << "| ";
             for (const auto& colName : colsToPrint) {
-                std::cout << std::left << std::setw(colWidths[colName]) << colName << " | ";
+                result << std::left << std::setw(colWidths[colName]) << colName << " | ";
             }
-            std::cout << "\n";
-            std::cout << "|";
+            result << "\n";
+            result << "|";
             for (const auto& colName : colsToPrint) {
-                std::cout << std::string(colWidths[colName] + 2, '-') << "|";
-            }
-            std::cout << "\n";
-
-            // 3. Imprimir las filas formateadas
-            for (const auto& row : rowsToPrint) {
-                std::cout << "| ";
-                for (const auto& colName : colsToPrint) {
-                    auto cellIt = row.find(colName);
-                    if (cellIt != row.end()) {
-                        std::visit([&](auto&& arg) {
-                            std::cout << std::left << std::setw(colWidths[colName]) << arg << " | ";
-                        }, cellIt->second);
-                    } else {
-                        std::cout << std::left << std::setw(colWidths[colName] + 3) << " | "; // Espacio para celda vacía
+                result << std::string(colWidths[colName] + 2, '-') << "|";
+            }
+            result << "\n";
+
+            // 3. Imprimir las filas formateadas, partición por partición
+            for (const auto& rows : partitionRows) {
+                for (const auto& row : rows) {
+                    result << "| ";
+                    for (const auto& colName : colsToPrint) {
+                        auto cellIt = row.find(colName);
+                        std::string cellStr = cellIt != row.end() ? formatCell(cellIt->second) : "NULL";
+                        result << std::left << std::setw(colWidths[colName]) << cellStr << " | ";
                     }
+                    result << "\n";
                 }
-                std::cout << "\n";
             }
             // --- Fin de la nueva lógica de formato ---
+            out << result.str();
+            if (resultCache.isEnabled()) {
+                resultCache.insert(cacheKey, version, result.str());
+            }
             break;
         }
         case CommandType::DELETE: {
-            auto it = tables.find(command.tableName);
-            if (it == tables.end()) {
-                std::cout << "Error: La tabla '" << command.tableName << "' no existe.\n";
+            auto tableOpt = schemaTable(command.tableName);
+            if (!tableOpt) {
+                out << "Error: La tabla '" << command.tableName << "' no existe.\n";
+                return;
+            }
+            if (command.whereClause && !checkWhereLiterals(*command.whereClause, tableOpt->getColumns(), out)) {
                 return;
             }
 
-            auto& table = it->second;
-            int rowsDeleted = table.deleteRows(
-                [&](const Row& row) {
-                    if (command.whereClause) {
-                        return checkCondition(row, *command.whereClause);
-                    }
-                    return true; // Borra todo si no hay WHERE
+            auto targets = resolveTargets(command);
+            if (command.explain) {
+                explainTargets(command, targets, out);
+                return;
+            }
+            // Cada partición está bajo su propio bloqueo de escritura: se borran
+            // en paralelo igual que se recorren en SELECT
+            std::atomic<int> rowsDeleted{0};
+            forEachTarget(targets.size(), [&](size_t index) {
+                auto& table = *targets[index].second;
+                AccessPlan plan = choosePlan(table, command.whereClause);
+                std::optional<Filter> filter;
+                if (command.whereClause) {
+                    filter.emplace(*command.whereClause, table.getColumns(), command.tableName, predicateStats);
+                }
+                auto candidates = fetchCandidates(table, plan);
+                // Sin WHERE el selector es nulo y se borra todo
+                rowsDeleted += table.deleteRows(
+                    filter ? filter->selector() : nullptr,
+                    filter ? filter->blockFilter() : nullptr,
+                    candidates ? &*candidates : nullptr
+                );
+            });
+            out << rowsDeleted << " fila(s) eliminada(s).\n";
+            if (rowsDeleted > 0) {
+                {
+                    std::lock_guard<std::mutex> lock(compactionSignalMutex);
+                    compactionRequested = true;
                 }
-            );
-            std::cout << rowsDeleted << " fila(s) eliminada(s).\n";
+                compactionCv.notify_one();
+            }
             break;
         }
         case CommandType::UPDATE: {
-            auto it = tables.find(command.tableName);
-            if (it == tables.end()) {
-                std::cout << "Error: La tabla '" << command.tableName << "' no existe.\n";
+            auto tableOpt = schemaTable(command.tableName);
+            if (!tableOpt) {
+                out << "Error: La tabla '" << command.tableName << "' no existe.\n";
                 return;
             }
 
-            auto& table = it->second;
-            const auto& columns = table.getColumns();
+            const auto& columns = tableOpt->getColumns();
+            // Columnas y literales se resuelven una vez; un valor inválido aborta la sentencia
+            std::vector<Assignment> assignments;
+            if (!compileAssignments(columns, command.setClauses, assignments, out)) {
+                return;
+            }
+            if (command.whereClause && !checkWhereLiterals(*command.whereClause, columns, out)) {
+                return;
+            }
+            // Cambiar la clave obligaría a mover la fila a otra partición
+            auto schemeIt = partitionSchemes.find(command.tableName);
+            if (schemeIt != partitionSchemes.end()) {
+                for (const auto& assignment : assignments) {
+                    if (assignment.column == schemeIt->second.column) {
+                        out << "Error: No se puede actualizar la columna de partición '" << assignment.column << "'.\n";
+                        return;
+                    }
+                }
+            }
 
-            int rowsUpdated = table.updateRows(
-                // Función de condición
-                [&](const Row& row) {
+            auto targets = resolveTargets(command);
+            if (command.explain) {
+                explainTargets(command, targets, out);
+                return;
+            }
+            // Un resultado que no cabe en su columna aborta la sentencia antes de
+            // modificar ninguna partición
+            bool narrowing = std::any_of(assignments.begin(), assignments.end(), [&](const Assignment& a) {
+                return a.op != 0 && isIntegral(columns[a.columnIndex].type);
+            });
+            std::vector<const Assignment*> overflows(targets.size(), nullptr);
+            if (narrowing) {
+                forEachTarget(targets.size(), [&](size_t index) {
+                    const auto& table = *targets[index].second;
+                    AccessPlan plan = choosePlan(table, command.whereClause);
+                    std::optional<Filter> filter;
                     if (command.whereClause) {
-                        return checkCondition(row, *command.whereClause);
-                    }
-                    return true; // Actualiza todo si no hay WHERE
-                },
-                // Función de actualización
-                [&](Row& row) {
-                    for (const auto& setClause : command.setClauses) {
-                        // Encontrar el tipo de la columna que se va a actualizar
-                        auto colIt = std::find_if(columns.begin(), columns.end(), 
-                            [&](const Column& c){ return c.name == setClause.column; });
-
-                        if (colIt != columns.end()) {
-                            try {
-                                if (colIt->type == DataType::INTEGER) {
-                                    row[setClause.column] = std::stoi(setClause.value);
-                                } else { // TEXT
-                                    row[setClause.column] = setClause.value;
-                                }
-                            } catch (const std::invalid_argument& e) {
-                                std::cout << "Error: Valor '" << setClause.value << "' no es válido para la columna '" << setClause.column << "' de tipo INTEGER.\n";
-                                // Podríamos detener la actualización aquí si un valor es inválido
-                            } catch (const std::out_of_range& e) {
-                                std::cout << "Error: Valor '" << setClause.value << "' fuera de rango para tipo INTEGER.\n";
-                            }
-                        } else {
-                             std::cout << "Error: La columna '" << setClause.column << "' no existe en la tabla.\n";
-                        }
+                        filter.emplace(*command.whereClause, columns, command.tableName, predicateStats);
                     }
+                    auto candidates = fetchCandidates(table, plan);
+                    overflows[index] = findOverflow(table, assignments, filter ? filter->blockFilter() : nullptr,
+                                                    filter ? filter->selector() : nullptr,
+                                                    candidates ? &*candidates : nullptr);
+                });
+            }
+            // Se informa la primera partición en orden, no la primera en terminar
+            for (const Assignment* overflow : overflows) {
+                if (overflow) {
+                    out << "Error: El resultado no cabe en la columna '" << overflow->column << "' de tipo "
+                        << typeName(columns[overflow->columnIndex].type) << ".\n";
+                    return;
                 }
-            );
+            }
 
-            std::cout << rowsUpdated << " fila(s) actualizada(s).\n";
+            std::vector<std::string> changedColumns;
+            for (const auto& assignment : assignments) {
+                changedColumns.push_back(assignment.column);
+            }
+            std::atomic<int> rowsUpdated{0};
+            forEachTarget(targets.size(), [&](size_t index) {
+                auto& table = *targets[index].second;
+                AccessPlan plan = choosePlan(table, command.whereClause);
+                std::optional<Filter> filter;
+                if (command.whereClause) {
+                    filter.emplace(*command.whereClause, columns, command.tableName, predicateStats);
+                }
+                auto candidates = fetchCandidates(table, plan);
+
+                // Sin WHERE el selector es nulo y se actualiza todo
+                rowsUpdated += table.updateRows(
+                    filter ? filter->selector() : nullptr,
+                    [&](ColumnPage& page, const std::vector<size_t>& selection) {
+                        applyAssignments(assignments, page, selection);
+                    },
+                    changedColumns,
+                    filter ? filter->blockFilter() : nullptr,
+                    candidates ? &*candidates : nullptr
+                );
+            });
+
+            out << rowsUpdated << " fila(s) actualizada(s).\n";
+            break;
+        }
+        case CommandType::SHOW_STATS: {
+            // Un checkpoint o una carga pueden cambiar 'segments' a la vez
+            std::unordered_map<std::string, size_t> unloadedRows;
+            {
+                std::lock_guard<std::mutex> segmentsLock(segmentsMutex);
+                for (const auto& tableName : unloadedTables) {
+                    unloadedRows[tableName] = segments.at(tableName).rows;
+                }
+            }
+            for (const auto& pair : tables) {
+                const auto& table = pair.second;
+                auto unloadedIt = unloadedRows.find(pair.first);
+                if (unloadedIt != unloadedRows.end()) {
+                    out << pair.first << ": sin cargar (" << unloadedIt->second
+                              << " fila(s) según el catálogo).\n";
+                    continue;
+                }
+                out << pair.first << ": " << table.getRowCount() << " fila(s) en "
+                          << table.getBlocks().size() << " bloque(s), "
+                          << table.getRowsSkipped() << " fila(s) omitida(s) por zone maps, "
+                          << table.getDeletedRowCount() << " borrada(s) pendiente(s) de compactar, "
+                          << table.getCompactedBlocks() << " bloque(s) compactado(s).\n";
+            }
+            auto poolStats = bufferPool->getStats();
+            out << "Buffer pool: " << poolStats.residentBytes / 1024 << " KB de "
+                      << poolStats.budget / 1024 << " KB, " << poolStats.residentPages << "/"
+                      << poolStats.totalPages << " página(s) en memoria, " << poolStats.hits << " acierto(s), "
+                      << poolStats.misses << " fallo(s), " << poolStats.prefetches << " lectura(s) anticipada(s), "
+                      << poolStats.evictions << " desalojo(s), " << poolStats.writeBacks << " escritura(s)";
+            if (poolStats.spillErrors > 0) {
+                out << ", " << poolStats.spillErrors << " error(es) de escritura";
+            }
+            out << ".\n";
+            auto cacheStats = resultCache.getStats();
+            if (cacheStats.capacity > 0) {
+                out << "Caché de resultados: " << cacheStats.bytes / 1024 << " KB de "
+                          << cacheStats.capacity / 1024 << " KB, " << cacheStats.entries << " entrada(s), "
+                          << cacheStats.hits << " acierto(s), " << cacheStats.misses << " fallo(s), "
+                          << cacheStats.invalidations << " invalidada(s), " << cacheStats.evictions << " desalojo(s).\n";
+            } else {
+                out << "Caché de resultados: desactivada.\n";
+            }
+            out << "Checkpoints: " << checkpointsDone << " completado(s); el último escribió "
+                      << lastCheckpointTables << " tabla(s), " << lastCheckpointBytes << " bytes.\n";
+            if (replicationRole == ReplicationRole::PRIMARY) {
+                out << "Replicación: primario, último LSN " << replicationLog.lastLsn() << ", log '"
+                          << replicationLogPath(db_name) << "'.\n";
+            } else if (replicationRole == ReplicationRole::FOLLOWER) {
+                out << "Replicación: réplica de '" << db_name << "', LSN aplicado " << appliedLsn << ", "
+                          << receivedLsn - appliedLsn << " registro(s) pendiente(s), retraso "
+                          << replicationLagMs << " ms, " << resyncCount << " sincronización(es) completa(s)"
+                          << (replicaSynced ? "" : ", esperando un checkpoint del primario") << ".\n";
+            }
+            break;
+        }
+        case CommandType::SET_OPTION: {
+            const auto& option = command.setClauses.front();
+            if (option.column == "buffer_pool_mb") {
+                try {
+                    size_t megabytes = std::stoul(option.value);
+                    bufferPool->setBudget(megabytes * 1024 * 1024);
+                    out << "Buffer pool: " << megabytes << " MB.\n";
+                } catch (const std::exception& e) {
+                    out << "Error: Valor '" << option.value << "' no es válido para '" << option.column << "'.\n";
+                }
+            } else if (option.column == "result_cache_mb") {
+                try {
+                    size_t megabytes = std::stoul(option.value);
+                    resultCache.setCapacity(megabytes * 1024 * 1024);
+                    out << "Caché de resultados: " << (megabytes > 0 ? option.value + " MB" : "desactivada") << ".\n";
+                } catch (const std::exception& e) {
+                    out << "Error: Valor '" << option.value << "' no es válido para '" << option.column << "'.\n";
+                }
+            } else if (option.column == "checkpoint_interval_s") {
+                try {
+                    long seconds = std::stol(option.value);
+                    if (seconds < 0) throw std::invalid_argument("negativo");
+                    {
+                        std::lock_guard<std::mutex> lock(checkpointSignalMutex);
+                        checkpointInterval = std::chrono::seconds(seconds);
+                        checkpointIntervalChanged = true;
+                    }
+                    checkpointCv.notify_one();
+                    out << "Checkpoint periódico: " << (seconds > 0 ? "cada " + option.value + " s" : "desactivado") << ".\n";
+                } catch (const std::exception& e) {
+                    out << "Error: Valor '" << option.value << "' no es válido para '" << option.column << "'.\n";
+                }
+            } else if (option.column == "compaction_threshold") {
+                try {
+                    double threshold = std::stod(option.value);
+                    if (threshold < 0.0 || threshold > 1.0) throw std::out_of_range("umbral");
+                    {
+                        std::lock_guard<std::mutex> lock(compactionSignalMutex);
+                        compactionThreshold = threshold;
+                        compactionRequested = true;
+                    }
+                    compactionCv.notify_one();
+                    out << "Compactación: " << (threshold > 0.0 ? "bloques con al menos " + option.value + " de filas borradas" : "desactivada") << ".\n";
+                } catch (const std::exception& e) {
+                    out << "Error: Valor '" << option.value << "' no es válido para '" << option.column << "'.\n";
+                }
+            } else {
+                out << "Error: Opción '" << option.column << "' desconocida.\n";
+            }
+            break;
+        }
+        case CommandType::CHECKPOINT: {
+            // Se ejecuta en segundo plano para no bloquear la sentencia en E/S
+            requestCheckpoint();
+            out << "Checkpoint solicitado.\n";
+            break;
+        }
+        case CommandType::ANALYZE: {
+            if (!command.tableName.empty()) {
+                if (!schemaTable(command.tableName)) {
+                    out << "Error: La tabla '" << command.tableName << "' no existe.\n";
+                    return;
+                }
+                for (const auto& target : resolveTargets(command)) {
+                    target.second->setStats(analyzeTable(*target.second));
+                    out << "Tabla '" << target.first << "' analizada (" << target.second->getRowCount() << " filas).\n";
+                }
+                return;
+            }
+            for (auto& pair : tables) {
+                pair.second.setStats(analyzeTable(pair.second));
+                out << "Tabla '" << pair.first << "' analizada (" << pair.second.getRowCount() << " filas).\n";
+            }
             break;
         }
         case CommandType::UNRECOGNIZED:
-            std::cout << "Error: Comando no reconocido o sintaxis incorrecta.\n";
+            out << "Error: Comando no reconocido o sintaxis incorrecta.\n";
             break;
     }
 }
 
-// Nueva implementación de guardado
-void Database::save()
+// Escribe la entrada de catálogo de una tabla: columnas, índices y estadísticas
+static void writeCatalogEntry(std::ostream& out, const std::string& tableName, const Table& table)
 {
-    std::ofstream db_file(db_name);
-    if (!db_file.is_open()) {
-        // Opcional: Manejar error si no se puede abrir el archivo.
-        return;
+    out << "[TABLE:" << tableName << "]\n";
+
+    // Escribir cabecera (columnas)
+    const auto& columns = table.getColumns();
+    for (size_t i = 0; i < columns.size(); ++i) { // id INTEGER,nombre TEXT
+        out << columns[i].name << " " << typeName(columns[i].type) << (i == columns.size() - 1 ? "" : ",");
+    }
+    out << "\n";
+
+    // Escribir índices y estadísticas de ANALYZE
+    for (const auto& column : table.getIndexedColumns()) {
+        out << "[INDEX:" << table.getIndexName(column) << " " << column << "]\n";
+    }
+    const auto& stats = table.getStats();
+    if (stats.analyzed) {
+        out << "[ANALYZED:" << stats.rowCount << "]\n";
+        for (const auto& statsPair : stats.columns) {
+            const auto& colStats = statsPair.second;
+            out << "[STATS:" << statsPair.first << " " << colStats.distinct << " "
+                << colStats.nullCount << " " << colStats.histogram.size();
+            for (int64_t bound : colStats.histogram) out << " " << bound;
+            out << "]\n";
+        }
+    }
+}
+
+// Escribe los bloques de una tabla: zone maps seguidos de sus filas.
+// Las celdas NULL se escriben como \N y las barras de los TEXT, duplicadas.
+static void writeBlocks(std::ostream& out, const Table& table)
+{
+    table.forEachBlock([&](const RowBlock& block, const ColumnPage& page) {
+        out << "[BLOCK]\n";
+        for (const auto& zonePair : block.zones) {
+            const auto& zone = zonePair.second;
+            out << "[ZONE:" << zonePair.first << " " << zone.min << " " << zone.max << " "
+                << zone.nullCount << " " << zone.hasValues << "]\n";
+        }
+        for (size_t r = 0; r < page.size(); ++r) {
+            if (block.isDeleted(r)) continue; // Los tombstones no se guardan
+            for (size_t i = 0; i < page.columnCount(); ++i) {
+                auto cell = page.column(i).get(r);
+                if (!cell) {
+                    out << NULL_MARKER;
+                } else if (auto text = std::get_if<std::string>(&*cell)) {
+                    out << escapeText(*text);
+                } else {
+                    out << formatCell(*cell);
+                }
+                out << (i == page.columnCount() - 1 ? "" : ",");
+            }
+            out << "\n";
+        }
+    });
+}
+
+// Escribe 'contents' en un temporal, lo sincroniza con fsync y lo renombra sobre
+// 'path'. Un fallo a mitad de camino deja intacta la versión anterior.
+static bool writeFileAtomically(const std::string& path, const std::string& contents)
+{
+    std::string tmpPath = path + ".tmp";
+    FILE* file = std::fopen(tmpPath.c_str(), "wb");
+    if (!file) return false;
+
+    bool ok = std::fwrite(contents.data(), 1, contents.size(), file) == contents.size();
+    ok = ok && std::fflush(file) == 0 && ::fsync(fileno(file)) == 0;
+    ok = (std::fclose(file) == 0) && ok;
+    if (!ok || std::rename(tmpPath.c_str(), path.c_str()) != 0) {
+        std::remove(tmpPath.c_str());
+        return false;
+    }
+    return true;
+}
+
+// Sincroniza un directorio para que los renombres sean durables
+static void syncDirectory(const std::string& dir)
+{
+    int fd = ::open(dir.c_str(), O_RDONLY);
+    if (fd >= 0) {
+        ::fsync(fd);
+        ::close(fd);
+    }
+}
+
+void Database::requestCheckpoint()
+{
+    {
+        std::lock_guard<std::mutex> lock(checkpointSignalMutex);
+        checkpointRequested = true;
+    }
+    checkpointCv.notify_one();
+}
+
+void Database::checkpointLoop()
+{
+    std::unique_lock<std::mutex> lock(checkpointSignalMutex);
+    while (!stopping) {
+        auto interval = checkpointInterval;
+        auto wakeUp = [this] { return stopping || checkpointRequested || checkpointIntervalChanged; };
+        bool signaled = true;
+        if (interval.count() > 0) {
+            signaled = checkpointCv.wait_for(lock, interval, wakeUp);
+        } else {
+            checkpointCv.wait(lock, wakeUp);
+        }
+        if (stopping) break;
+        if (signaled && !checkpointRequested) {
+            // Cambió el intervalo: volver a esperar con el valor nuevo
+            checkpointIntervalChanged = false;
+            continue;
+        }
+        checkpointRequested = false;
+        checkpointIntervalChanged = false;
+
+        lock.unlock();
+        checkpoint();
+        lock.lock();
+    }
+}
+
+void Database::compactionLoop()
+{
+    std::unique_lock<std::mutex> lock(compactionSignalMutex);
+    while (!compactionStopping) {
+        compactionCv.wait_for(lock, COMPACTION_POLL_INTERVAL,
+                              [this] { return compactionStopping || compactionRequested; });
+        if (compactionStopping) break;
+        compactionRequested = false;
+        double threshold = compactionThreshold;
+        if (threshold <= 0.0) continue;
+
+        // Un bloque por vez: las sentencias solo esperan lo que tarda un bloque
+        lock.unlock();
+        while (compactNextBlock(threshold)) {
+            std::lock_guard<std::mutex> stopLock(compactionSignalMutex);
+            if (compactionStopping) break;
+        }
+        lock.lock();
+    }
+}
+
+// Con 'stateMutex' compartido solo se bloquea una tabla a la vez: se busca el
+// bloque con su bloqueo de lectura y se compacta con el de escritura, así las
+// demás tablas no esperan nunca
+bool Database::compactNextBlock(double threshold)
+{
+    std::shared_lock<std::shared_mutex> stateLock(stateMutex);
+    for (auto& pair : tables) {
+        auto lockIt = tableLocks.find(pair.first);
+        if (lockIt == tableLocks.end()) continue;
+        {
+            std::shared_lock<std::shared_mutex> readLock(*lockIt->second);
+            if (!pair.second.findCompactionCandidate(threshold)) continue;
+        }
+        // Entre los dos bloqueos pudo cambiar la tabla: se vuelve a buscar
+        std::unique_lock<std::shared_mutex> writeLock(*lockIt->second);
+        auto block = pair.second.findCompactionCandidate(threshold);
+        if (!block) continue;
+        try {
+            pair.second.compactBlock(*block);
+        } catch (const std::exception& e) {
+            return false; // Página ilegible: se reintenta en la próxima pasada
+        }
+        return true;
     }
+    return false;
+}
 
-    for (const auto& pair : tables) {
-        const auto& tableName = pair.first;
-        const auto& table = pair.second;
+// Checkpoint incremental: solo se reescriben los segmentos de las tablas
+// modificadas desde el último checkpoint. Cada segmento nuevo tiene un nombre
+// nuevo y el catálogo se publica con un rename atómico, así que un fallo en
+// cualquier punto deja el checkpoint anterior completo y utilizable.
+bool Database::checkpoint()
+{
+    if (replicationRole == ReplicationRole::FOLLOWER) {
+        return false; // Los archivos son del primario
+    }
+    std::lock_guard<std::mutex> checkpointLock(checkpointMutex);
 
-        db_file << "[TABLE:" << tableName << "]\n";
+    struct PendingSegment {
+        std::string tableName;
+        std::string file;
+        std::string contents;
+        uint64_t version;
+        size_t rows;
+    };
+    std::vector<PendingSegment> pending;
+    std::ostringstream catalog;
+    bool replicating = replicationLog.isOpen();
+    uint64_t checkpointLsn = 0;
 
-        // Escribir cabecera (columnas)
-        const auto& columns = table.getColumns();
-        for (size_t i = 0; i < columns.size(); ++i) { // id INTEGER,nombre TEXT
-            db_file << columns[i].name << " " << (columns[i].type == DataType::INTEGER ? "INTEGER" : "TEXT") << (i == columns.size() - 1 ? "" : ",");
+    {
+        // Foto consistente sin detener las sentencias: con 'stateMutex'
+        // compartido no corre ninguna sentencia exclusiva, y con el bloqueo de
+        // lectura de todas las tablas ninguna escritura está a medias (cada
+        // sentencia se registra en el log con sus bloqueos tomados). Las lecturas
+        // no esperan nunca; las escrituras de una tabla modificada esperan solo
+        // mientras se serializa esa tabla, y la de las demás, casi nada.
+        std::shared_lock<std::shared_mutex> stateLock(stateMutex);
+        std::vector<std::string> names;
+        for (const auto& pair : tableLocks) names.push_back(pair.first);
+        std::sort(names.begin(), names.end()); // Mismo orden que las sentencias
+        std::unordered_map<std::string, std::shared_lock<std::shared_mutex>> readLocks;
+        for (const auto& name : names) {
+            readLocks.emplace(name, std::shared_lock<std::shared_mutex>(*tableLocks.at(name)));
         }
-        db_file << "\n";
 
-        // Escribir filas
-        for (const auto& row : table.getRows()) {
-            for (size_t i = 0; i < columns.size(); ++i) {
-                const auto& colName = columns[i];
-                auto it = row.find(colName.name);
-                if (it != row.end()) {
-                    std::visit([&db_file](auto&& arg){
-                        db_file << arg;
-                    }, it->second);
+        if (replicating) {
+            // Ninguna sentencia replicada está a medias: la foto incluye
+            // exactamente los registros del log hasta este LSN
+            checkpointLsn = replicationLog.lastLsn();
+            catalog << "[REPLICATION:" << replicationLog.getEpoch() << " " << checkpointLsn << "]\n";
+        }
+        for (const auto& pair : partitionSchemes) {
+            catalog << "[PARTITIONED:" << pair.first << " " << formatScheme(pair.second) << "]\n";
+        }
+
+        // Con todas las tablas quietas se toman sus entradas del catálogo. Las
+        // tablas sin cambios reutilizan su segmento y se liberan ya; las tablas
+        // sin cargar conservan la versión 0 y también lo reutilizan.
+        std::unordered_map<std::string, std::string> entries;
+        std::unordered_map<std::string, SegmentState> tableSegments;
+        {
+            std::lock_guard<std::mutex> segmentsLock(segmentsMutex);
+            for (const auto& pair : tables) {
+                std::ostringstream entry;
+                writeCatalogEntry(entry, pair.first, pair.second);
+                entries[pair.first] = entry.str();
+                auto stateIt = segments.find(pair.first);
+                if (stateIt != segments.end() && stateIt->second.version == pair.second.getVersion()) {
+                    tableSegments[pair.first] = stateIt->second;
+                    readLocks.erase(pair.first);
                 }
-                db_file << (i == columns.size() - 1 ? "" : ",");
             }
-            db_file << "\n";
         }
-        db_file << "[END_TABLE]\n";
+
+        // Las tablas modificadas se serializan de una en una y se liberan al terminar
+        for (const auto& pair : tables) {
+            if (tableSegments.count(pair.first)) continue;
+            SegmentState& segment = tableSegments[pair.first];
+            segment.file = pair.first + "." + std::to_string(++segmentSequence) + ".tbl";
+            segment.rows = pair.second.getRowCount();
+            std::ostringstream contents;
+            try {
+                writeBlocks(contents, pair.second);
+            } catch (const std::exception& e) {
+                return false; // Página ilegible: el checkpoint anterior sigue vigente
+            }
+            pending.push_back({pair.first, segment.file, contents.str(), pair.second.getVersion(), segment.rows});
+            segment.bytes = pending.back().contents.size();
+            readLocks.erase(pair.first);
+        }
+
+        for (const auto& pair : tables) {
+            const SegmentState& segment = tableSegments.at(pair.first);
+            catalog << entries.at(pair.first);
+            catalog << "[SEGMENT:" << segment.file << " " << segment.rows << " " << segment.bytes << "]\n";
+            catalog << "[END_TABLE]\n";
+        }
     }
+    // Desde aquí la escritura de archivos, fsync y renombres no toman ningún bloqueo
+
+    std::string catalogContents = catalog.str();
+    if (pending.empty() && catalogContents == lastCatalog) {
+        return true; // Nada cambió desde el último checkpoint
+    }
+
+    std::string segmentDir = db_name + ".d";
+    std::error_code ec;
+    std::filesystem::create_directories(segmentDir, ec);
+
+    size_t bytesWritten = 0;
+    for (const auto& segment : pending) {
+        if (!writeFileAtomically(segmentDir + "/" + segment.file, segment.contents)) {
+            return false;
+        }
+        bytesWritten += segment.contents.size();
+    }
+    syncDirectory(segmentDir);
+
+    if (!writeFileAtomically(db_name, catalogContents)) {
+        return false;
+    }
+    auto parent = std::filesystem::path(db_name).parent_path();
+    syncDirectory(parent.empty() ? "." : parent.string());
+    bytesWritten += catalogContents.size();
+
+    // El catálogo nuevo ya está publicado: los segmentos reemplazados sobran
+    std::lock_guard<std::mutex> segmentsLock(segmentsMutex);
+    for (const auto& segment : pending) {
+        auto stateIt = segments.find(segment.tableName);
+        if (stateIt != segments.end()) {
+            std::filesystem::remove(segmentDir + "/" + stateIt->second.file, ec);
+        }
+        segments[segment.tableName] = {segment.file, segment.version, segment.rows, segment.contents.size()};
+    }
+
+    // Las réplicas nuevas parten de este catálogo: el log solo necesita lo posterior
+    if (replicating) {
+        replicationLog.truncateThrough(checkpointLsn);
+    }
+
+    lastCatalog = std::move(catalogContents);
+    checkpointsDone++;
+    lastCheckpointTables = pending.size();
+    lastCheckpointBytes = bytesWritten;
+    return true;
+}
+
+// Convierte una línea CSV de un bloque en una fila
+static Row parseRow(const std::string& line, const std::vector<Column>& columns)
+{
+    Row row;
+    std::stringstream row_ss(line);
+    std::string value;
+    for (const auto& col : columns) {
+        std::getline(row_ss, value, ',');
+        if (value == NULL_MARKER) continue;
+        if (col.type == DataType::TEXT) value = unescapeText(value);
+        // Un valor inválido en la carga queda como NULL
+        if (auto cell = parseCell(value, col.type)) {
+            row[col.name] = std::move(*cell);
+        }
+    }
+    return row;
+}
+
+// Parsea "[ZONE:col min max nulos hayValores]"
+static bool parseZone(const std::string& line, std::string& colName, ZoneMap& zone)
+{
+    std::stringstream zone_ss(line.substr(6, line.size() - 7));
+    return static_cast<bool>(zone_ss >> colName >> zone.min >> zone.max >> zone.nullCount >> zone.hasValues);
 }
 
-// Nueva implementación de carga
+// Lee un segmento línea a línea y agrega cada bloque a 'table' en cuanto se
+// completa: en memoria solo están las filas de un bloque; las páginas quedan
+// en el buffer pool. No toca el estado de la base de datos, así que puede
+// correr sin bloqueo. Devuelve false si el archivo no se pudo abrir o leer.
+bool Database::readSegment(const std::string& path, size_t expectedBytes, Table& table, std::ostream& out)
+{
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) {
+        out << "Error: No se pudo abrir el segmento '" << path << "'.\n";
+        return false;
+    }
+
+    const auto& columns = table.getColumns();
+    bool inBlock = false;
+    std::vector<Row> blockRows;
+    std::unordered_map<std::string, ZoneMap> blockZones;
+    auto flushBlock = [&]() {
+        table.appendBlock(std::move(blockRows), std::move(blockZones));
+        blockRows.clear();
+        blockZones.clear();
+    };
+
+    size_t bytesRead = 0;
+    std::string line;
+    while (std::getline(file, line)) {
+        bytesRead += line.size() + (file.eof() ? 0 : 1);
+        if (line == "[BLOCK]") {
+            flushBlock();
+            inBlock = true;
+        } else if (!inBlock) {
+            continue; // Contenido fuera de un bloque: se ignora
+        } else if (line.rfind("[ZONE:", 0) == 0) {
+            std::string colName;
+            ZoneMap zone;
+            if (parseZone(line, colName, zone)) {
+                blockZones[colName] = zone;
+            }
+        } else {
+            blockRows.push_back(parseRow(line, columns));
+        }
+    }
+    if (file.bad()) {
+        out << "Error: No se pudo leer el segmento '" << path << "'.\n";
+        return false;
+    }
+    flushBlock();
+
+    if (expectedBytes > 0 && bytesRead != expectedBytes) {
+        out << "Aviso: El segmento '" << path << "' no tiene el tamaño indicado en el catálogo.\n";
+    }
+    return true;
+}
+
+// Carga solo el catálogo: columnas, índices, estadísticas y el segmento de
+// cada tabla. Las filas se leen al usar la tabla por primera vez (getTable)
+// o en segundo plano si la precarga está activada.
 void Database::load()
 {
     std::ifstream db_file(db_name);
     if (!db_file.is_open()) {
         return; // El archivo no existe, no hay nada que cargar.
     }
+    loadCatalog(db_file);
 
+    // Borrar segmentos huérfanos de un checkpoint interrumpido
+    std::lock_guard<std::mutex> segmentsLock(segmentsMutex);
+    std::error_code ec;
+    for (const auto& entry : std::filesystem::directory_iterator(db_name + ".d", ec)) {
+        std::string file = entry.path().filename().string();
+        bool referenced = std::any_of(segments.begin(), segments.end(),
+                                      [&](const auto& pair) { return pair.second.file == file; });
+        if (!referenced) {
+            std::filesystem::remove(entry.path(), ec);
+        }
+    }
+}
+
+void Database::loadCatalog(std::istream& db_file)
+{
     std::string line;
     std::string currentTable;
     std::vector<Column> currentColumns;
+    // Bloque en construcción. Los archivos antiguos no tienen [BLOCK] y
+    // sus filas se insertan una a una.
+    bool inBlock = false;
+    std::vector<Row> blockRows;
+    std::unordered_map<std::string, ZoneMap> blockZones;
+
+    auto flushBlock = [&]() {
+        if (inBlock) {
+            tables.at(currentTable).appendBlock(std::move(blockRows), std::move(blockZones));
+            blockRows.clear();
+            blockZones.clear();
+        }
+        inBlock = false;
+    };
 
     while (std::getline(db_file, line)) {
-        if (line.rfind("[TABLE:", 0) == 0) {
+        if (line.rfind("[REPLICATION:", 0) == 0) {
+            // Posición del log de replicación incluida en este checkpoint
+            std::stringstream replication_ss(line.substr(13, line.size() - 14));
+            replication_ss >> catalogEpoch >> catalogLsn;
+        } else if (line.rfind("[PARTITIONED:", 0) == 0) {
+            // Esquema de una tabla particionada; sus particiones son tablas "nombre#n"
+            std::string text = line.substr(13, line.size() - 14);
+            size_t space = text.find(' ');
+            auto scheme = space == std::string::npos ? std::nullopt : parseScheme(text.substr(space + 1));
+            if (scheme) {
+                partitionSchemes[text.substr(0, space)] = *scheme;
+            }
+        } else if (line.rfind("[TABLE:", 0) == 0) {
             currentTable = line.substr(7, line.size() - 8);
             // Leer cabecera (columnas con tipos)
-            if (std::getline(db_file, line)) {
-                std::stringstream ss(line);
+            std::string header;
+            if (std::getline(db_file, header)) {
+                std::stringstream ss(header);
                 std::string columnDef;
                 currentColumns.clear();
                 while (std::getline(ss, columnDef, ',')) {
                     std::stringstream def_ss(columnDef);
                     std::string name, typeStr;
                     def_ss >> name >> typeStr;
-                    if (typeStr == "INTEGER") {
-                        currentColumns.push_back({name, DataType::INTEGER});
-                    } else {
-                        currentColumns.push_back({name, DataType::TEXT});
-                    }
+                    currentColumns.push_back({name, parseType(typeStr).value_or(DataType::TEXT)});
                 }
                 createTable(currentTable, currentColumns);
             }
         } else if (line == "[END_TABLE]") {
+            flushBlock();
             currentTable.clear();
             currentColumns.clear();
-        } else if (!currentTable.empty()) {
-            Row row;
-            std::stringstream row_ss(line);
-            std::string value;
-            for (const auto& col : currentColumns) {
-                std::getline(row_ss, value, ',');
-                if (col.type == DataType::INTEGER) {
-                    try {
-                        row[col.name] = std::stoi(value);
-                    } catch(...) { /* Ignorar valor inválido en la carga */ }
-                } else {
-                    row[col.name] = value;
+        } else if (line == "[BLOCK]" && !currentTable.empty()) {
+            flushBlock();
+            inBlock = true;
+        } else if (line.rfind("[SEGMENT:", 0) == 0 && !currentTable.empty()) {
+            // [SEGMENT:archivo filas bytes]; los catálogos anteriores solo traen el archivo
+            std::stringstream segment_ss(line.substr(9, line.size() - 10));
+            SegmentState segment;
+            segment_ss >> segment.file >> segment.rows >> segment.bytes;
+            // En un resync, ensureLoaded puede estar consultándolos a la vez
+            std::lock_guard<std::mutex> segmentsLock(segmentsMutex);
+            segments[currentTable] = segment;
+            unloadedTables.insert(currentTable);
+        } else if (line.rfind("[INDEX:", 0) == 0 && !currentTable.empty()) {
+            std::stringstream index_ss(line.substr(7, line.size() - 8));
+            std::string indexName, column;
+            if (index_ss >> indexName >> column) {
+                tables.at(currentTable).createIndex(indexName, column);
+            }
+        } else if (line.rfind("[ANALYZED:", 0) == 0 && !currentTable.empty()) {
+            TableStats stats = tables.at(currentTable).getStats();
+            stats.analyzed = true;
+            stats.rowCount = std::stoul(line.substr(10, line.size() - 11));
+            tables.at(currentTable).setStats(stats);
+        } else if (line.rfind("[STATS:", 0) == 0 && !currentTable.empty()) {
+            std::stringstream stats_ss(line.substr(7, line.size() - 8));
+            std::string column;
+            ColumnStats colStats;
+            size_t bounds = 0;
+            if (stats_ss >> column >> colStats.distinct >> colStats.nullCount >> bounds) {
+                int64_t bound;
+                for (size_t i = 0; i < bounds && stats_ss >> bound; ++i) {
+                    colStats.histogram.push_back(bound);
                 }
+                TableStats stats = tables.at(currentTable).getStats();
+                stats.columns[column] = std::move(colStats);
+                tables.at(currentTable).setStats(std::move(stats));
+            }
+        } else if (line.rfind("[ZONE:", 0) == 0 && inBlock) {
+            std::string colName;
+            ZoneMap zone;
+            if (parseZone(line, colName, zone)) {
+                blockZones[colName] = zone;
+            }
+        } else if (!currentTable.empty()) {
+            // Formato antiguo: filas dentro del propio archivo
+            Row row = parseRow(line, currentColumns);
+            if (inBlock) {
+                blockRows.push_back(std::move(row));
+            } else {
+                insertInto(currentTable, row);
             }
-            insertInto(currentTable, row);
         }
     }
+
+    // Las tablas con segmento siguen en disco sin cargar (versión 0); las de
+    // un archivo antiguo (filas en línea) se escribirán en el próximo checkpoint.
+    std::lock_guard<std::mutex> segmentsLock(segmentsMutex);
+    for (const auto& tableName : unloadedTables) {
+        auto& segment = segments.at(tableName);
+        segment.version = tables.at(tableName).getVersion();
+        // Los nombres son tabla.N.tbl: continuar la numeración sin pisar segmentos vigentes
+        std::string stem = std::filesystem::path(segment.file).stem().string();
+        try {
+            segmentSequence = std::max<uint64_t>(segmentSequence, std::stoull(stem.substr(stem.rfind('.') + 1)));
+        } catch (const std::exception& e) { /* Nombre inesperado: se ignora */ }
+    }
 }
@@ -0,0 +1,354 @@
+#include "MiniDB/Filter.hpp"
+#include <algorithm>
+#include <iterator>
+
+Filter::Filter(const WhereExpr& expr, const std::vector<Column>& columns,
+               const std::string& tableName, PredicateStatsMap& statsMap)
+    : stats(statsMap)
+{
+    std::lock_guard<std::mutex> lock(stats.mutex);
+    root = compile(expr, columns, tableName);
+}
+
+Filter::~Filter()
+{
+    std::lock_guard<std::mutex> lock(stats.mutex);
+    commit(root);
+}
+
+Filter::Node Filter::compile(const WhereExpr& expr, const std::vector<Column>& columns, const std::string& tableName)
+{
+    Node node;
+    node.type = expr.type;
+
+    if (expr.type != ExprType::PREDICATE) {
+        node.cost = 0.0;
+        for (const auto& child : expr.children) {
+            node.children.push_back(compile(child, columns, tableName));
+            node.cost += node.children.back().cost;
+        }
+        return node;
+    }
+
+    const auto& wc = expr.predicate;
+    node.column = wc.column;
+    node.text = wc.value;
+    if (wc.op == "!=") node.op = CompareOp::NE;
+    else if (wc.op == ">") node.op = CompareOp::GT;
+    else if (wc.op == "<") node.op = CompareOp::LT;
+    else if (wc.op == ">=") node.op = CompareOp::GE;
+    else if (wc.op == "<=") node.op = CompareOp::LE;
+    else if (wc.op == "IS NULL") node.op = CompareOp::IS_NULL;
+    else if (wc.op == "IS NOT NULL") node.op = CompareOp::IS_NOT_NULL;
+    else node.op = CompareOp::EQ;
+
+    auto colIt = std::find_if(columns.begin(), columns.end(),
+                              [&](const Column& c) { return c.name == wc.column; });
+    if (colIt != columns.end()) {
+        node.columnIndex = colIt - columns.begin();
+        node.columnType = colIt->type;
+    }
+
+    // Convertir el literal una sola vez al tipo de la columna. Los enteros se
+    // comparan en 64 bits: "smallint_col < 100000" es válido.
+    if (isIntegral(node.columnType)) {
+        auto value = parseCell(wc.value, DataType::BIGINT);
+        node.literalValid = value.has_value();
+        if (value) node.integer = std::get<int64_t>(*value);
+    } else if (node.columnType == DataType::DOUBLE) {
+        auto value = parseCell(wc.value, DataType::DOUBLE);
+        node.literalValid = value.has_value();
+        if (value) node.real = std::get<double>(*value);
+    } else if (node.columnType == DataType::BOOLEAN) {
+        auto value = parseCell(wc.value, DataType::BOOLEAN);
+        node.literalValid = value.has_value();
+        if (value) node.flag = std::get<bool>(*value);
+    } else {
+        node.literalValid = true;
+    }
+
+    // Comparar strings cuesta más que comparar números
+    node.cost = (node.columnIndex && node.columnType == DataType::TEXT) ? 2.0 : 1.0;
+
+    node.statsKey = tableName + "." + wc.column + " " + wc.op;
+    auto statsIt = stats.entries.find(node.statsKey);
+    if (statsIt != stats.entries.end()) {
+        node.history = statsIt->second;
+    }
+    return node;
+}
+
+double Filter::selectivity(const Node& node)
+{
+    switch (node.type) {
+        case ExprType::PREDICATE: {
+            uint64_t evaluated = node.history.evaluated + node.seen.evaluated;
+            uint64_t passed = node.history.passed + node.seen.passed;
+            if (evaluated > 0) {
+                return static_cast<double>(passed) / evaluated;
+            }
+            // Sin historial: valores por defecto según el operador
+            if (node.op == CompareOp::EQ || node.op == CompareOp::IS_NULL) return 0.1;
+            if (node.op == CompareOp::NE || node.op == CompareOp::IS_NOT_NULL) return 0.9;
+            return 0.33;
+        }
+        case ExprType::AND: {
+            double s = 1.0;
+            for (const auto& child : node.children) s *= selectivity(child);
+            return s;
+        }
+        case ExprType::OR: {
+            double miss = 1.0;
+            for (const auto& child : node.children) miss *= 1.0 - selectivity(child);
+            return 1.0 - miss;
+        }
+        case ExprType::NOT:
+            return 1.0 - selectivity(node.children.front());
+    }
+    return 1.0;
+}
+
+bool Filter::nodeMayMatch(const Node& node, const RowBlock& block)
+{
+    switch (node.type) {
+        case ExprType::PREDICATE: {
+            auto zoneIt = block.zones.find(node.column);
+            if (zoneIt == block.zones.end()) {
+                return true; // Sin metadatos útiles: hay que recorrer el bloque
+            }
+            const auto& zone = zoneIt->second;
+            if (node.op == CompareOp::IS_NULL) return zone.nullCount > 0;
+            if (node.op == CompareOp::IS_NOT_NULL) return zone.hasValues;
+            if (!zone.hasValues) {
+                return false; // Todas las filas son nulas, ninguna cumple la condición
+            }
+            if (!node.literalValid) return true;
+            int64_t value = node.integer;
+            switch (node.op) {
+                case CompareOp::EQ: return zone.min <= value && value <= zone.max;
+                case CompareOp::NE: return !(zone.min == value && zone.max == value);
+                case CompareOp::GT: return zone.max > value;
+                case CompareOp::LT: return zone.min < value;
+                case CompareOp::GE: return zone.max >= value;
+                case CompareOp::LE: return zone.min <= value;
+                default: break;
+            }
+            return true;
+        }
+        case ExprType::AND:
+            return std::all_of(node.children.begin(), node.children.end(),
+                               [&](const Node& c) { return nodeMayMatch(c, block); });
+        case ExprType::OR:
+            return std::any_of(node.children.begin(), node.children.end(),
+                               [&](const Node& c) { return nodeMayMatch(c, block); });
+        case ExprType::NOT:
+            return true; // Los zone maps no permiten descartar una negación
+    }
+    return true;
+}
+
+// Recorre el arreglo de una columna quedándose con las filas no nulas cuyo
+// valor cumple 'matches'. Un bucle por tipo y operador, sin variantes.
+template <typename T, typename Predicate>
+static void selectWhere(const std::vector<T>& values, const ColumnVector& column, const std::vector<size_t>& in,
+                        std::vector<size_t>& out, Predicate matches)
+{
+    for (size_t i : in) {
+        if (column.isValid(i) && matches(values[i])) out.push_back(i);
+    }
+}
+
+void Filter::evaluateLeaf(const Node& node, const ColumnPage& page, const std::vector<size_t>& in,
+                          std::vector<size_t>& out)
+{
+    if (!node.columnIndex) {
+        return; // La columna no existe en la tabla
+    }
+    const auto& column = page.column(*node.columnIndex);
+    if (node.op == CompareOp::IS_NULL || node.op == CompareOp::IS_NOT_NULL) {
+        bool wantValid = node.op == CompareOp::IS_NOT_NULL;
+        for (size_t i : in) {
+            if (column.isValid(i) == wantValid) out.push_back(i);
+        }
+        return;
+    }
+    if (!node.literalValid) {
+        return; // El literal no es del tipo de la columna
+    }
+
+    // Comparaciones de orden: solo para columnas numéricas
+    auto compare = [&](const auto& values, auto literal) {
+        switch (node.op) {
+            case CompareOp::EQ: selectWhere(values, column, in, out, [=](auto v) { return v == literal; }); break;
+            case CompareOp::NE: selectWhere(values, column, in, out, [=](auto v) { return v != literal; }); break;
+            case CompareOp::GT: selectWhere(values, column, in, out, [=](auto v) { return v > literal; }); break;
+            case CompareOp::LT: selectWhere(values, column, in, out, [=](auto v) { return v < literal; }); break;
+            case CompareOp::GE: selectWhere(values, column, in, out, [=](auto v) { return v >= literal; }); break;
+            case CompareOp::LE: selectWhere(values, column, in, out, [=](auto v) { return v <= literal; }); break;
+            default: break;
+        }
+    };
+    switch (column.type) {
+        case DataType::SMALLINT: compare(column.smallints, node.integer); break;
+        case DataType::INTEGER: compare(column.ints, node.integer); break;
+        case DataType::BIGINT: compare(column.bigints, node.integer); break;
+        case DataType::DOUBLE: compare(column.doubles, node.real); break;
+        case DataType::BOOLEAN: {
+            // BOOLEAN y TEXT: solo igualdad/desigualdad
+            uint8_t flag = node.flag;
+            if (node.op == CompareOp::EQ) selectWhere(column.bools, column, in, out, [=](uint8_t v) { return v == flag; });
+            if (node.op == CompareOp::NE) selectWhere(column.bools, column, in, out, [=](uint8_t v) { return v != flag; });
+            break;
+        }
+        case DataType::TEXT: {
+            const auto& text = node.text;
+            if (node.op == CompareOp::EQ) selectWhere(column.texts, column, in, out, [&](const std::string& v) { return v == text; });
+            if (node.op == CompareOp::NE) selectWhere(column.texts, column, in, out, [&](const std::string& v) { return v != text; });
+            break;
+        }
+    }
+}
+
+void Filter::evaluate(Node& node, const ColumnPage& page, const std::vector<size_t>& in, std::vector<size_t>& out)
+{
+    out.clear();
+    switch (node.type) {
+        case ExprType::PREDICATE: {
+            evaluateLeaf(node, page, in, out);
+            node.seen.evaluated += in.size();
+            node.seen.passed += out.size();
+            break;
+        }
+        case ExprType::AND: {
+            // Primero los operandos más baratos y que más filas descartan
+            std::stable_sort(node.children.begin(), node.children.end(), [](const Node& a, const Node& b) {
+                return (selectivity(a) - 1.0) / a.cost < (selectivity(b) - 1.0) / b.cost;
+            });
+            std::vector<size_t> current = in, next;
+            for (auto& child : node.children) {
+                if (current.empty()) break;
+                evaluate(child, page, current, next);
+                current.swap(next);
+            }
+            out.swap(current);
+            break;
+        }
+        case ExprType::OR: {
+            // Primero los operandos más baratos y que más filas aceptan
+            std::stable_sort(node.children.begin(), node.children.end(), [](const Node& a, const Node& b) {
+                return selectivity(a) / a.cost > selectivity(b) / b.cost;
+            });
+            std::vector<size_t> remaining = in, matched, rest, merged;
+            for (auto& child : node.children) {
+                if (remaining.empty()) break;
+                evaluate(child, page, remaining, matched);
+                // Las filas aceptadas ya no necesitan evaluar los demás operandos
+                rest.clear();
+                std::set_difference(remaining.begin(), remaining.end(), matched.begin(), matched.end(),
+                                    std::back_inserter(rest));
+                remaining.swap(rest);
+                merged.clear();
+                std::merge(out.begin(), out.end(), matched.begin(), matched.end(), std::back_inserter(merged));
+                out.swap(merged);
+            }
+            break;
+        }
+        case ExprType::NOT:
+            evaluateFalse(node.children.front(), page, in, out);
+            break;
+    }
+}
+
+void Filter::evaluateFalse(Node& node, const ColumnPage& page, const std::vector<size_t>& in, std::vector<size_t>& out)
+{
+    out.clear();
+    switch (node.type) {
+        case ExprType::PREDICATE: {
+            std::vector<size_t> matched;
+            evaluateLeaf(node, page, in, matched);
+            node.seen.evaluated += in.size();
+            node.seen.passed += matched.size();
+            // IS [NOT] NULL nunca es UNKNOWN. Una comparación es UNKNOWN sobre una
+            // celda NULL, con el literal NULL o con una columna que no existe.
+            bool nullTest = node.op == CompareOp::IS_NULL || node.op == CompareOp::IS_NOT_NULL;
+            if (!nullTest && (!node.columnIndex || !node.literalValid)) break;
+            const ColumnVector* column = node.columnIndex ? &page.column(*node.columnIndex) : nullptr;
+            auto matchIt = matched.begin();
+            for (size_t i : in) {
+                if (matchIt != matched.end() && *matchIt == i) {
+                    ++matchIt;
+                } else if (nullTest || column->isValid(i)) {
+                    out.push_back(i);
+                }
+            }
+            break;
+        }
+        case ExprType::AND: {
+            // FALSE si algún operando es FALSE
+            std::vector<size_t> remaining = in, failed, rest, merged;
+            for (auto& child : node.children) {
+                if (remaining.empty()) break;
+                evaluateFalse(child, page, remaining, failed);
+                rest.clear();
+                std::set_difference(remaining.begin(), remaining.end(), failed.begin(), failed.end(),
+                                    std::back_inserter(rest));
+                remaining.swap(rest);
+                merged.clear();
+                std::merge(out.begin(), out.end(), failed.begin(), failed.end(), std::back_inserter(merged));
+                out.swap(merged);
+            }
+            break;
+        }
+        case ExprType::OR: {
+            // FALSE si todos los operandos son FALSE
+            std::vector<size_t> current = in, next;
+            for (auto& child : node.children) {
+                if (current.empty()) break;
+                evaluateFalse(child, page, current, next);
+                current.swap(next);
+            }
+            out.swap(current);
+            break;
+        }
+        case ExprType::NOT:
+            evaluate(node.children.front(), page, in, out);
+            break;
+    }
+}
+
+void Filter::select(const ColumnPage& page, std::vector<size_t>& selection)
+{
+    std::vector<size_t> result;
+    evaluate(root, page, selection, result);
+    selection.swap(result);
+}
+
+BlockFilter Filter::blockFilter() const
+{
+    return [this](const RowBlock& block) { return mayMatch(block); };
+}
+
+RowSelector Filter::selector()
+{
+    return [this](const ColumnPage& page, std::vector<size_t>& selection) { select(page, selection); };
+}
+
+bool Filter::mayMatch(const RowBlock& block) const
+{
+    return nodeMayMatch(root, block);
+}
+
+void Filter::commit(const Node& node)
+{
+    if (node.type == ExprType::PREDICATE) {
+        if (node.seen.evaluated > 0) {
+            auto& entry = stats.entries[node.statsKey];
+            entry.evaluated += node.seen.evaluated;
+            entry.passed += node.seen.passed;
+        }
+        return;
+    }
+    for (const auto& child : node.children) {
+        commit(child);
+    }
+}
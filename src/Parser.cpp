@@ -1,6 +1,7 @@
 #include "MiniDB/Parser.hpp"
 #include <sstream>
 #include <algorithm>
+#include <cctype>
 
 // Función auxiliar para dividir un string en tokens
 std::vector<std::string> tokenize(const std::string& singleCommand) {
@@ -49,6 +50,198 @@ std::vector<std::string> parseParenthesizedList(const std::string& listStr) {
     return items;
 }
 
+// Divide el texto de una condición WHERE en tokens: paréntesis, operadores,
+// literales entre comillas y palabras. Permite escribir "id>=5" sin espacios.
+std::vector<std::string> tokenizeCondition(const std::string& text) {
+    std::vector<std::string> tokens;
+    size_t i = 0;
+    while (i < text.size()) {
+        char c = text[i];
+        if (c == ' ' || c == '\t') {
+            i++;
+        } else if (c == '(' || c == ')') {
+            tokens.emplace_back(1, c);
+            i++;
+        } else if (c == '\'') {
+            size_t end = text.find('\'', i + 1);
+            end = (end == std::string::npos) ? text.size() : end + 1;
+            tokens.push_back(text.substr(i, end - i));
+            i = end;
+        } else if (c == '=' || c == '!' || c == '<' || c == '>') {
+            size_t len = (i + 1 < text.size() && text[i + 1] == '=') ? 2 : 1;
+            tokens.push_back(text.substr(i, len));
+            i += len;
+        } else {
+            size_t end = text.find_first_of(" \t()'=!<>", i);
+            if (end == std::string::npos) end = text.size();
+            tokens.push_back(text.substr(i, end - i));
+            i = end;
+        }
+    }
+    return tokens;
+}
+
+// Parser descendente recursivo para expresiones WHERE:
+//   expr    := and ( OR and )*
+//   and     := unary ( AND unary )*
+//   unary   := NOT unary | '(' expr ')' | columna op valor | columna IS [NOT] NULL
+class ConditionParser {
+public:
+    explicit ConditionParser(std::vector<std::string> toks) : tokens(std::move(toks)) {}
+
+    std::optional<WhereExpr> parse() {
+        auto expr = parseOr();
+        if (!expr || pos != tokens.size()) return std::nullopt; // Tokens sobrantes
+        return expr;
+    }
+
+private:
+    bool accept(const std::string& token) {
+        if (pos < tokens.size() && tokens[pos] == token) {
+            pos++;
+            return true;
+        }
+        return false;
+    }
+
+    // Une operandos de AND/OR en un solo nodo n-ario
+    std::optional<WhereExpr> parseList(ExprType type, const std::string& keyword,
+                                       std::optional<WhereExpr> (ConditionParser::*next)()) {
+        auto first = (this->*next)();
+        if (!first) return std::nullopt;
+
+        WhereExpr node;
+        node.type = type;
+        node.children.push_back(std::move(*first));
+        while (accept(keyword)) {
+            auto operand = (this->*next)();
+            if (!operand) return std::nullopt;
+            if (operand->type == type) {
+                for (auto& child : operand->children) node.children.push_back(std::move(child));
+            } else {
+                node.children.push_back(std::move(*operand));
+            }
+        }
+        if (node.children.size() == 1) return std::move(node.children.front());
+        return node;
+    }
+
+    std::optional<WhereExpr> parseOr() {
+        return parseList(ExprType::OR, "OR", &ConditionParser::parseAnd);
+    }
+
+    std::optional<WhereExpr> parseAnd() {
+        return parseList(ExprType::AND, "AND", &ConditionParser::parseUnary);
+    }
+
+    std::optional<WhereExpr> parseUnary() {
+        if (accept("NOT")) {
+            auto operand = parseUnary();
+            if (!operand) return std::nullopt;
+            WhereExpr node;
+            node.type = ExprType::NOT;
+            node.children.push_back(std::move(*operand));
+            return node;
+        }
+        if (accept("(")) {
+            auto inner = parseOr();
+            if (!inner || !accept(")")) return std::nullopt;
+            return inner;
+        }
+
+        // columna IS [NOT] NULL: el operador lleva la negación y el valor queda vacío
+        if (pos + 1 < tokens.size() && tokens[pos + 1] == "IS") {
+            bool negated = pos + 2 < tokens.size() && tokens[pos + 2] == "NOT";
+            size_t nullPos = pos + (negated ? 3 : 2);
+            if (nullPos >= tokens.size() || tokens[nullPos] != "NULL") return std::nullopt;
+            WhereExpr leaf;
+            leaf.predicate = WhereClause{tokens[pos], negated ? "IS NOT NULL" : "IS NULL", ""};
+            pos = nullPos + 1;
+            return leaf;
+        }
+
+        // columna op valor
+        if (pos + 3 > tokens.size()) return std::nullopt;
+        const auto& op = tokens[pos + 1];
+        if (op != "=" && op != "!=" && op != ">" && op != "<" && op != ">=" && op != "<=") {
+            return std::nullopt;
+        }
+        WhereExpr leaf;
+        leaf.predicate = WhereClause{tokens[pos], op, tokens[pos + 2]};
+        pos += 3;
+        return leaf;
+    }
+
+    std::vector<std::string> tokens;
+    size_t pos = 0;
+};
+
+// Parsea los tokens que siguen a WHERE
+std::optional<WhereExpr> parseWhere(std::vector<std::string>::const_iterator begin,
+                                    std::vector<std::string>::const_iterator end) {
+    std::string text;
+    for (auto it = begin; it != end; ++it) {
+        text += *it + " ";
+    }
+    ConditionParser conditionParser(tokenizeCondition(text));
+    return conditionParser.parse();
+}
+
+// ¿Es el '+' o '-' en 'pos' el signo del exponente de un literal real (1e-5)?
+// Lo es si va tras una 'e' cuyo término empieza como número: "c1e-1" resta.
+static bool isExponentSign(const std::string& expr, size_t pos) {
+    if (pos < 2 || (expr[pos - 1] != 'e' && expr[pos - 1] != 'E')) return false;
+    size_t start = expr.find_last_of(" \t+-*/", pos - 2);
+    start = start == std::string::npos ? 0 : start + 1;
+    bool digits = false, dot = false;
+    for (size_t i = start; i < pos - 1; ++i) {
+        if (std::isdigit(static_cast<unsigned char>(expr[i]))) digits = true;
+        else if (expr[i] == '.' && !dot) dot = true;
+        else return false;
+    }
+    return digits;
+}
+
+// Parsea una asignación de UPDATE: "col = valor" o "col = col2 op valor"
+static std::optional<SetClause> parseAssignment(const std::string& text) {
+    size_t eq = text.find('=');
+    if (eq == std::string::npos) return std::nullopt;
+
+    SetClause clause;
+    std::stringstream column_ss(text.substr(0, eq));
+    std::string extra;
+    if (!(column_ss >> clause.column) || column_ss >> extra) return std::nullopt;
+
+    std::string expr = text.substr(eq + 1);
+    expr.erase(0, expr.find_first_not_of(" \t"));
+    expr.erase(expr.find_last_not_of(" \t") + 1);
+    if (expr.empty()) return std::nullopt;
+    if (expr.front() == '\'') {
+        // Literal de texto: no se buscan operadores dentro de las comillas
+        if (expr.size() < 2 || expr.back() != '\'') return std::nullopt;
+        clause.value = expr;
+        return clause;
+    }
+
+    // El primer carácter no puede ser operador para admitir literales negativos
+    size_t opPos = expr.find_first_of("+-*/", 1);
+    while (opPos != std::string::npos && isExponentSign(expr, opPos)) {
+        opPos = expr.find_first_of("+-*/", opPos + 1);
+    }
+    if (opPos == std::string::npos) {
+        if (expr.find_first_of(" \t") != std::string::npos) return std::nullopt;
+        clause.value = expr;
+        return clause;
+    }
+
+    std::stringstream left_ss(expr.substr(0, opPos));
+    std::stringstream right_ss(expr.substr(opPos + 1));
+    if (!(left_ss >> clause.sourceColumn) || left_ss >> extra) return std::nullopt;
+    if (!(right_ss >> clause.value) || right_ss >> extra) return std::nullopt;
+    clause.op = expr[opPos];
+    return clause;
+}
+
 Command Parser::parse(const std::string& query) {
     std::string commandStr = query;
 
@@ -56,12 +249,31 @@ Command Parser::parse(const std::string& query) {
     commandStr.erase(0, commandStr.find_first_not_of(" \t\n\r"));
     commandStr.erase(commandStr.find_last_not_of(" \t\n\r") + 1);
 
+    Command cmd = parseStatement(commandStr);
+    cmd.text = commandStr;
+    return cmd;
+}
+
+Command Parser::parseStatement(const std::string& commandStr) {
     auto tokens = tokenize(commandStr);
     if (tokens.empty()) return Command{CommandType::UNRECOGNIZED};
 
+    // EXPLAIN <sentencia>: se parsea la sentencia y se marca para mostrar su plan
+    if (tokens[0] == "EXPLAIN" && tokens.size() > 1) {
+        Command cmd = parse(commandStr.substr(commandStr.find("EXPLAIN") + 7));
+        if (cmd.type != CommandType::SELECT && cmd.type != CommandType::UPDATE && cmd.type != CommandType::DELETE) {
+            return Command{CommandType::UNRECOGNIZED};
+        }
+        cmd.explain = true;
+        return cmd;
+    }
+
     if (tokens[0] == "CREATE" && tokens.size() > 2 && tokens[1] == "TABLE") {
         return parseCreate(tokens);
     }
+    if (tokens[0] == "CREATE" && tokens.size() > 2 && tokens[1] == "INDEX") {
+        return parseCreateIndex(tokens);
+    }
     if (tokens[0] == "INSERT" && tokens.size() > 2 && tokens[1] == "INTO") {
         return parseInsert(tokens);
     }
@@ -74,26 +286,89 @@ Command Parser::parse(const std::string& query) {
     if (tokens[0] == "UPDATE" && tokens.size() > 3) {
         return parseUpdate(tokens);
     }
+    if (tokens[0] == "SHOW" && tokens.size() == 2 && tokens[1] == "STATS") {
+        return Command{CommandType::SHOW_STATS};
+    }
+    if (tokens[0] == "SET" && tokens.size() == 4 && tokens[2] == "=") {
+        // SET opcion = valor
+        Command cmd;
+        cmd.type = CommandType::SET_OPTION;
+        cmd.setClauses.push_back({tokens[1], tokens[3]});
+        return cmd;
+    }
+    if (tokens[0] == "CHECKPOINT" && tokens.size() == 1) {
+        return Command{CommandType::CHECKPOINT};
+    }
+    if (tokens[0] == "ANALYZE" && tokens.size() <= 2) {
+        // ANALYZE [table_name]: sin tabla se analizan todas
+        Command cmd;
+        cmd.type = CommandType::ANALYZE;
+        if (tokens.size() == 2) cmd.tableName = tokens[1];
+        return cmd;
+    }
     return Command{CommandType::UNRECOGNIZED};
 }
 
+// Parsea "PARTITION BY HASH(col) PARTITIONS n" o
+// "PARTITION BY RANGE(col) VALUES (b1, b2, ...)"
+static std::optional<PartitionScheme> parsePartitionClause(std::vector<std::string>::const_iterator begin,
+                                                           std::vector<std::string>::const_iterator end) {
+    std::string text;
+    for (auto it = begin; it != end; ++it) {
+        std::string token = *it;
+        std::replace(token.begin(), token.end(), ',', ' ');
+        text += token + " ";
+    }
+    auto toks = tokenizeCondition(text);
+    if (toks.size() < 6 || toks[0] != "PARTITION" || toks[1] != "BY" || toks[3] != "(" || toks[5] != ")") {
+        return std::nullopt;
+    }
+
+    PartitionScheme scheme;
+    scheme.column = toks[4];
+    try {
+        if (toks[2] == "HASH" && toks.size() == 8 && toks[6] == "PARTITIONS") {
+            scheme.method = PartitionMethod::HASH;
+            scheme.count = std::stoul(toks[7]);
+            return scheme;
+        }
+        if (toks[2] == "RANGE" && toks.size() > 9 && toks[6] == "VALUES" && toks[7] == "(" && toks.back() == ")") {
+            scheme.method = PartitionMethod::RANGE;
+            for (size_t i = 8; i + 1 < toks.size(); ++i) {
+                scheme.bounds.push_back(std::stoi(toks[i]));
+            }
+            scheme.count = scheme.bounds.size() + 1;
+            return scheme;
+        }
+    } catch (const std::exception& e) {
+        return std::nullopt;
+    }
+    return std::nullopt;
+}
+
 Command Parser::parseCreate(std::vector<std::string>& tokens) {
-    // CREATE TABLE table_name (col1,col2,...)
+    // CREATE TABLE table_name (col1,col2,...) [PARTITION BY ...]
     if (tokens.size() < 4) return Command{CommandType::UNRECOGNIZED};
     
     Command cmd;
     cmd.type = CommandType::CREATE_TABLE;
     cmd.tableName = tokens[2];
+
+    auto partitionIt = std::find(tokens.begin() + 3, tokens.end(), "PARTITION");
+    if (partitionIt != tokens.end()) {
+        cmd.partition = parsePartitionClause(partitionIt, tokens.end());
+        if (!cmd.partition) return Command{CommandType::UNRECOGNIZED};
+    }
     
     // Juntar el resto de los tokens para formar la lista de columnas
     std::string columnList;
-    for (size_t i = 3; i < tokens.size(); ++i) {
-        columnList += tokens[i] + " ";
+    for (auto it = tokens.begin() + 3; it != partitionIt; ++it) {
+        columnList += *it + " ";
     }
     // Quitar el último espacio extra
     if (!columnList.empty()) columnList.pop_back();
 
-    if (columnList.front() != '(' || columnList.back() != ')') {
+    if (columnList.empty() || columnList.front() != '(' || columnList.back() != ')') {
         return Command{CommandType::UNRECOGNIZED};
     }
 
@@ -105,16 +380,33 @@ Command Parser::parseCreate(std::vector<std::string>& tokens) {
 
         if (name.empty() || typeStr.empty()) return Command{CommandType::UNRECOGNIZED};
 
-        DataType type;
-        if (typeStr == "INTEGER") {
-            type = DataType::INTEGER;
-        } else if (typeStr == "TEXT") {
-            type = DataType::TEXT;
-        } else {
+        auto type = parseType(typeStr);
+        if (!type) {
             return Command{CommandType::UNRECOGNIZED}; // Tipo no soportado
         }
-        cmd.columns.push_back({name, type});
+        cmd.columns.push_back({name, *type});
+    }
+    return cmd;
+}
+
+Command Parser::parseCreateIndex(std::vector<std::string>& tokens) {
+    // CREATE INDEX index_name ON table_name (col)
+    if (tokens.size() < 6 || tokens[3] != "ON") return Command{CommandType::UNRECOGNIZED};
+
+    Command cmd;
+    cmd.type = CommandType::CREATE_INDEX;
+    cmd.indexName = tokens[2];
+    cmd.tableName = tokens[4];
+
+    std::string columnList;
+    for (size_t i = 5; i < tokens.size(); ++i) {
+        columnList += tokens[i];
+    }
+    if (columnList.size() < 3 || columnList.front() != '(' || columnList.back() != ')') {
+        return Command{CommandType::UNRECOGNIZED};
     }
+    cmd.columnNames = parseParenthesizedList(columnList);
+    if (cmd.columnNames.size() != 1) return Command{CommandType::UNRECOGNIZED}; // Solo índices de una columna
     return cmd;
 }
 
@@ -146,6 +438,7 @@ Command Parser::parseSelect(std::vector<std::string>& tokens) {
     // SELECT col1,col2 FROM table_name
     // SELECT * FROM table_name WHERE col = value
     // SELECT col1,col2 FROM table_name WHERE col = value
+    // SELECT * FROM table_name WHERE (a > 1 AND b = 'x') OR NOT c = 2
     auto fromIt = std::find(tokens.begin(), tokens.end(), "FROM");
     if (fromIt == tokens.end() || fromIt + 1 == tokens.end()) {
         return Command{CommandType::UNRECOGNIZED};
@@ -176,11 +469,9 @@ Command Parser::parseSelect(std::vector<std::string>& tokens) {
         if (fromIt + 1 >= whereIt) return Command{CommandType::UNRECOGNIZED}; // No hay nombre de tabla
         cmd.tableName = *(fromIt + 1);
 
-        // WHERE col op val (espera 4 tokens: WHERE, col, op, val)
-        if (std::distance(whereIt, tokens.end()) != 4) {
-            return Command{CommandType::UNRECOGNIZED};
-        }
-        cmd.whereClause = WhereClause{*(whereIt + 1), *(whereIt + 2), *(whereIt + 3)};
+        // WHERE con una expresión booleana (AND/OR/NOT y paréntesis)
+        cmd.whereClause = parseWhere(whereIt + 1, tokens.end());
+        if (!cmd.whereClause) return Command{CommandType::UNRECOGNIZED};
     }
 
     return cmd;
@@ -198,10 +489,11 @@ Command Parser::parseDelete(std::vector<std::string>& tokens) {
 
     if (tokens.size() > 3) { // Hay cláusula WHERE
         auto whereIt = std::find(tokens.begin() + 3, tokens.end(), "WHERE");
-        if (whereIt == tokens.end() || std::distance(whereIt, tokens.end()) != 4) {
+        if (whereIt == tokens.end()) {
             return Command{CommandType::UNRECOGNIZED};
         }
-        cmd.whereClause = WhereClause{*(whereIt + 1), *(whereIt + 2), *(whereIt + 3)};
+        cmd.whereClause = parseWhere(whereIt + 1, tokens.end());
+        if (!cmd.whereClause) return Command{CommandType::UNRECOGNIZED};
     }
     // Nota: DELETE sin WHERE es válido, pero por seguridad podríamos requerirlo.
     // Por ahora, lo permitimos.
@@ -222,19 +514,29 @@ Command Parser::parseUpdate(std::vector<std::string>& tokens) {
 
     auto whereIt = std::find(setIt, tokens.end(), "WHERE");
 
-    // Parsear SET clauses
-    // Por simplicidad, solo parseamos una cláusula SET: SET col = val
-    if (std::distance(setIt, whereIt) != 4 || *(setIt + 2) != "=") {
-         return Command{CommandType::UNRECOGNIZED};
+    // Parsear SET clauses: asignaciones separadas por comas (fuera de comillas)
+    std::string setText;
+    for (auto it = setIt + 1; it != whereIt; ++it) {
+        setText += *it + " ";
+    }
+    std::string assignment;
+    bool inQuotes = false;
+    for (char c : setText + ",") {
+        if (c == '\'') inQuotes = !inQuotes;
+        if (c == ',' && !inQuotes) {
+            auto clause = parseAssignment(assignment);
+            if (!clause) return Command{CommandType::UNRECOGNIZED};
+            cmd.setClauses.push_back(std::move(*clause));
+            assignment.clear();
+        } else {
+            assignment += c;
+        }
     }
-    cmd.setClauses.push_back({*(setIt + 1), *(setIt + 3)});
 
     // Parsear WHERE
     if (whereIt != tokens.end()) {
-        if (std::distance(whereIt, tokens.end()) != 4) {
-            return Command{CommandType::UNRECOGNIZED};
-        }
-        cmd.whereClause = WhereClause{*(whereIt + 1), *(whereIt + 2), *(whereIt + 3)};
+        cmd.whereClause = parseWhere(whereIt + 1, tokens.end());
+        if (!cmd.whereClause) return Command{CommandType::UNRECOGNIZED};
     }
     return cmd;
 }
\ No newline at end of file
@@ -0,0 +1,161 @@
+#include "MiniDB/Partition.hpp"
+#include <algorithm>
+#include <sstream>
+
+std::string partitionName(const std::string& tableName, size_t index)
+{
+    return tableName + PARTITION_SEPARATOR + std::to_string(index);
+}
+
+// Hash estable entre ejecuciones: las filas ya guardadas en una partición
+// deben seguir encontrándose al podar con el mismo valor
+static uint64_t fnv1a(const unsigned char* bytes, size_t size)
+{
+    uint64_t hash = 14695981039346656037ULL;
+    for (size_t i = 0; i < size; ++i) {
+        hash = (hash ^ bytes[i]) * 1099511628211ULL;
+    }
+    return hash;
+}
+
+static uint64_t stableHash(const CellValue& value)
+{
+    if (auto number = integralValue(value)) {
+        // Los enteros que caben en 32 bits conservan el hash de INTEGER;
+        // los más grandes se pliegan antes a 32 bits
+        uint64_t x = static_cast<uint32_t>(*number);
+        if (*number != static_cast<int32_t>(*number)) {
+            x = static_cast<uint32_t>(*number ^ (*number >> 32));
+        }
+        x = (x ^ (x >> 16)) * 0x45d9f3bULL;
+        x = (x ^ (x >> 16)) * 0x45d9f3bULL;
+        return x ^ (x >> 16);
+    }
+    if (auto real = std::get_if<double>(&value)) {
+        return fnv1a(reinterpret_cast<const unsigned char*>(real), sizeof(*real));
+    }
+    if (auto flag = std::get_if<bool>(&value)) {
+        return *flag;
+    }
+    const auto& text = std::get<std::string>(value);
+    return fnv1a(reinterpret_cast<const unsigned char*>(text.data()), text.size());
+}
+
+// Partición RANGE que contiene 'value'
+static size_t rangePartition(const PartitionScheme& scheme, int value)
+{
+    return std::upper_bound(scheme.bounds.begin(), scheme.bounds.end(), value) - scheme.bounds.begin();
+}
+
+size_t partitionFor(const PartitionScheme& scheme, const Row& row)
+{
+    auto it = row.find(scheme.column);
+    if (it == row.end()) return 0;
+    if (scheme.method == PartitionMethod::HASH) {
+        return stableHash(it->second) % scheme.count;
+    }
+    return std::holds_alternative<int>(it->second) ? rangePartition(scheme, std::get<int>(it->second)) : 0;
+}
+
+// Particiones que puede cumplir una comparación; las que no tocan la columna
+// de partición (o no se pueden evaluar) las admiten todas
+static std::vector<bool> prunePredicate(const PartitionScheme& scheme, DataType keyType, const WhereClause& wc)
+{
+    std::vector<bool> possible(scheme.count, true);
+    if (wc.column != scheme.column || wc.op == "!=") return possible;
+    auto parsed = parseCell(wc.value, keyType);
+    if (!parsed) return possible; // El filtro descartará las filas; no se poda
+    const CellValue& value = *parsed;
+
+    if (scheme.method == PartitionMethod::HASH) {
+        if (wc.op == "=") {
+            std::fill(possible.begin(), possible.end(), false);
+            possible[stableHash(value) % scheme.count] = true;
+        }
+        return possible;
+    }
+    if (!std::holds_alternative<int>(value)) return possible;
+    size_t partition = rangePartition(scheme, std::get<int>(value));
+    for (size_t i = 0; i < scheme.count; ++i) {
+        if ((wc.op == "=" || wc.op == ">" || wc.op == ">=") && i < partition) possible[i] = false;
+        if ((wc.op == "=" || wc.op == "<" || wc.op == "<=") && i > partition) possible[i] = false;
+    }
+    return possible;
+}
+
+// AND: intersección de sus operandos; OR: unión. NOT no poda: el
+// complemento de una partición puede estar en cualquiera.
+static std::vector<bool> pruneExpr(const PartitionScheme& scheme, DataType keyType, const WhereExpr& expr)
+{
+    switch (expr.type) {
+        case ExprType::PREDICATE:
+            return prunePredicate(scheme, keyType, expr.predicate);
+        case ExprType::AND: {
+            std::vector<bool> possible(scheme.count, true);
+            for (const auto& child : expr.children) {
+                auto childPossible = pruneExpr(scheme, keyType, child);
+                for (size_t i = 0; i < scheme.count; ++i) possible[i] = possible[i] && childPossible[i];
+            }
+            return possible;
+        }
+        case ExprType::OR: {
+            std::vector<bool> possible(scheme.count, false);
+            for (const auto& child : expr.children) {
+                auto childPossible = pruneExpr(scheme, keyType, child);
+                for (size_t i = 0; i < scheme.count; ++i) possible[i] = possible[i] || childPossible[i];
+            }
+            return possible;
+        }
+        default:
+            return std::vector<bool>(scheme.count, true);
+    }
+}
+
+std::vector<size_t> prunePartitions(const PartitionScheme& scheme, DataType keyType,
+                                    const std::optional<WhereExpr>& where)
+{
+    std::vector<size_t> result;
+    auto possible = where ? pruneExpr(scheme, keyType, *where) : std::vector<bool>(scheme.count, true);
+    for (size_t i = 0; i < scheme.count; ++i) {
+        if (possible[i]) result.push_back(i);
+    }
+    return result;
+}
+
+std::string formatScheme(const PartitionScheme& scheme)
+{
+    std::ostringstream oss;
+    if (scheme.method == PartitionMethod::HASH) {
+        oss << "HASH " << scheme.column << " " << scheme.count;
+    } else {
+        oss << "RANGE " << scheme.column << " " << scheme.bounds.size();
+        for (int bound : scheme.bounds) oss << " " << bound;
+    }
+    return oss.str();
+}
+
+std::optional<PartitionScheme> parseScheme(const std::string& text)
+{
+    std::stringstream ss(text);
+    std::string method;
+    PartitionScheme scheme;
+    size_t n = 0;
+    if (!(ss >> method >> scheme.column >> n)) return std::nullopt;
+
+    if (method == "HASH") {
+        scheme.method = PartitionMethod::HASH;
+        scheme.count = n;
+    } else if (method == "RANGE") {
+        scheme.method = PartitionMethod::RANGE;
+        int bound;
+        for (size_t i = 0; i < n && ss >> bound; ++i) {
+            scheme.bounds.push_back(bound);
+        }
+        if (scheme.bounds.size() != n) return std::nullopt;
+        scheme.count = n + 1;
+    } else {
+        return std::nullopt;
+    }
+    if (scheme.count == 0) return std::nullopt;
+    return scheme;
+}
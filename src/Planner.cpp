@@ -0,0 +1,165 @@
+#include "MiniDB/Planner.hpp"
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <sstream>
+
+// Costos relativos del modelo: leer una fila en orden secuencial frente a
+// saltar a una fila concreta desde un índice.
+constexpr double SEQ_ROW_COST = 1.0;
+constexpr double RANDOM_ROW_COST = 4.0;
+
+static const ColumnStats* columnStats(const Table& table, const std::string& column)
+{
+    const auto& stats = table.getStats();
+    if (!stats.analyzed) return nullptr;
+    auto it = stats.columns.find(column);
+    return it != stats.columns.end() ? &it->second : nullptr;
+}
+
+static std::optional<DataType> columnType(const Table& table, const std::string& column)
+{
+    for (const auto& col : table.getColumns()) {
+        if (col.name == column) return col.type;
+    }
+    return std::nullopt;
+}
+
+static double indexCost(double rows, double selectivity)
+{
+    // Descenso por el árbol del índice + acceso aleatorio a cada fila encontrada
+    return std::log2(rows + 1.0) + rows * selectivity * RANDOM_ROW_COST;
+}
+
+AccessPlan choosePlan(const Table& table, const std::optional<WhereExpr>& where)
+{
+    double rows = static_cast<double>(table.getRowCount());
+
+    AccessPlan best;
+    best.estimatedRows = rows;
+    best.cost = rows * SEQ_ROW_COST;
+    if (!where) return best;
+
+    // Predicados que toda fila del resultado debe cumplir
+    std::vector<const WhereClause*> conjuncts;
+    if (where->type == ExprType::PREDICATE) {
+        conjuncts.push_back(&where->predicate);
+    } else if (where->type == ExprType::AND) {
+        for (const auto& child : where->children) {
+            if (child.type == ExprType::PREDICATE) conjuncts.push_back(&child.predicate);
+        }
+    }
+
+    // Límites de rango acumulados por columna entera indexada
+    struct Bounds {
+        std::optional<int64_t> low, high;
+        bool lowInclusive = true, highInclusive = true;
+    };
+    std::map<std::string, Bounds> ranges;
+
+    for (const auto* wc : conjuncts) {
+        if (!table.hasIndex(wc->column)) continue;
+        auto type = columnType(table, wc->column);
+        if (!type) continue;
+
+        // Los límites se leen como BIGINT: pueden quedar fuera del rango de la columna
+        std::optional<int64_t> number;
+        if (isIntegral(*type)) {
+            if (auto literal = parseCell(wc->value, DataType::BIGINT)) number = integralValue(*literal);
+        }
+
+        if (wc->op == "=") {
+            // La clave del índice tiene el tipo (y ancho) de la columna
+            auto key = parseCell(wc->value, *type);
+            if (!key) continue;
+            double selectivity = estimateEquality(columnStats(table, wc->column), table.getRowCount(), number);
+            double cost = indexCost(rows, selectivity);
+            if (cost < best.cost) {
+                best = AccessPlan{};
+                best.method = AccessMethod::INDEX_LOOKUP;
+                best.column = wc->column;
+                best.key = *key;
+                best.estimatedRows = rows * selectivity;
+                best.cost = cost;
+            }
+            continue;
+        }
+
+        if (!number || wc->op == "!=") continue;
+
+        auto& bounds = ranges[wc->column];
+        if (wc->op == ">" || wc->op == ">=") {
+            bool inclusive = wc->op == ">=";
+            if (!bounds.low || *number > *bounds.low || (*number == *bounds.low && !inclusive)) {
+                bounds.low = number;
+                bounds.lowInclusive = inclusive;
+            }
+        } else if (wc->op == "<" || wc->op == "<=") {
+            bool inclusive = wc->op == "<=";
+            if (!bounds.high || *number < *bounds.high || (*number == *bounds.high && !inclusive)) {
+                bounds.high = number;
+                bounds.highInclusive = inclusive;
+            }
+        }
+    }
+
+    for (const auto& pair : ranges) {
+        const auto& bounds = pair.second;
+        double selectivity = estimateRange(columnStats(table, pair.first), table.getRowCount(),
+                                           bounds.low, bounds.lowInclusive, bounds.high, bounds.highInclusive);
+        double cost = indexCost(rows, selectivity);
+        if (cost < best.cost) {
+            best = AccessPlan{};
+            best.method = AccessMethod::INDEX_RANGE_SCAN;
+            best.column = pair.first;
+            best.low = bounds.low;
+            best.high = bounds.high;
+            best.lowInclusive = bounds.lowInclusive;
+            best.highInclusive = bounds.highInclusive;
+            best.estimatedRows = rows * selectivity;
+            best.cost = cost;
+        }
+    }
+    return best;
+}
+
+std::optional<CandidateMap> fetchCandidates(const Table& table, const AccessPlan& plan)
+{
+    switch (plan.method) {
+        case AccessMethod::INDEX_LOOKUP:
+            return table.indexLookup(plan.column, plan.key);
+        case AccessMethod::INDEX_RANGE_SCAN:
+            return table.indexRange(plan.column, plan.low, plan.lowInclusive, plan.high, plan.highInclusive);
+        case AccessMethod::FULL_SCAN:
+            break;
+    }
+    return std::nullopt;
+}
+
+std::string describePlan(const Table& table, const std::string& tableName, const AccessPlan& plan)
+{
+    std::ostringstream oss;
+    switch (plan.method) {
+        case AccessMethod::FULL_SCAN:
+            oss << "FULL SCAN sobre " << tableName;
+            break;
+        case AccessMethod::INDEX_LOOKUP:
+            oss << "INDEX LOOKUP sobre " << tableName << " usando " << table.getIndexName(plan.column)
+                << " (" << plan.column << " = ";
+            oss << formatCell(plan.key);
+            oss << ")";
+            break;
+        case AccessMethod::INDEX_RANGE_SCAN:
+            oss << "INDEX RANGE SCAN sobre " << tableName << " usando " << table.getIndexName(plan.column) << " (";
+            if (plan.low) oss << plan.column << (plan.lowInclusive ? " >= " : " > ") << *plan.low;
+            if (plan.low && plan.high) oss << " AND ";
+            if (plan.high) oss << plan.column << (plan.highInclusive ? " <= " : " < ") << *plan.high;
+            oss << ")";
+            break;
+    }
+    oss << "\n  filas estimadas: " << std::fixed;
+    oss.precision(1);
+    oss << plan.estimatedRows << ", costo estimado: " << plan.cost
+        << (table.getStats().analyzed ? "" : " (sin estadísticas, ejecuta ANALYZE)");
+    return oss.str();
+}
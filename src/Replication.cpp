@@ -0,0 +1,179 @@
+#include "MiniDB/Replication.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <sstream>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+std::string replicationLogPath(const std::string& dbName)
+{
+    return dbName + ".log";
+}
+
+int64_t currentTimeMillis()
+{
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+static std::string formatHeader(int64_t epoch, uint64_t startLsn)
+{
+    return "[LOG:" + std::to_string(epoch) + " " + std::to_string(startLsn) + "]\n";
+}
+
+static std::optional<LogHeader> parseHeader(const std::string& line)
+{
+    if (line.rfind("[LOG:", 0) != 0 || line.back() != ']') return std::nullopt; // rfind falla si está vacía
+    std::stringstream ss(line.substr(5, line.size() - 6));
+    LogHeader header;
+    if (!(ss >> header.epoch >> header.startLsn)) return std::nullopt;
+    return header;
+}
+
+static std::optional<LogRecord> parseRecord(const std::string& line)
+{
+    std::stringstream ss(line);
+    LogRecord record;
+    if (!(ss >> record.lsn >> record.timestampMs)) return std::nullopt;
+    ss.get(); // Espacio antes del SQL
+    std::getline(ss, record.sql);
+    return record;
+}
+
+// Escribe el log completo en un archivo temporal y lo publica con un rename
+// atómico: una réplica ve el log anterior o el nuevo, nunca uno a medias
+static bool replaceFile(const std::string& path, const std::string& contents)
+{
+    std::string tmpPath = path + ".tmp";
+    {
+        std::ofstream out(tmpPath, std::ios::binary | std::ios::trunc);
+        out << contents;
+        if (!out.flush()) return false;
+    }
+    if (std::rename(tmpPath.c_str(), path.c_str()) != 0) {
+        std::remove(tmpPath.c_str());
+        return false;
+    }
+    return true;
+}
+
+bool ReplicationLog::open(const std::string& logPath, int64_t logEpoch, uint64_t startLsn)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    path = logPath;
+    epoch = logEpoch;
+    lsn = startLsn;
+    if (!replaceFile(path, formatHeader(epoch, lsn))) return false;
+    file.open(path, std::ios::app | std::ios::binary);
+    return file.is_open();
+}
+
+bool ReplicationLog::isOpen() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return file.is_open();
+}
+
+uint64_t ReplicationLog::append(const std::string& sql)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!file.is_open()) return lsn;
+    // Un registro por línea: los saltos de línea del SQL se cambian por espacios
+    std::string line = sql;
+    std::replace(line.begin(), line.end(), '\n', ' ');
+    std::replace(line.begin(), line.end(), '\r', ' ');
+    file << ++lsn << ' ' << currentTimeMillis() << ' ' << line << '\n';
+    file.flush(); // Visible para las réplicas en cuanto termina la sentencia
+    return lsn;
+}
+
+uint64_t ReplicationLog::lastLsn() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return lsn;
+}
+
+int64_t ReplicationLog::getEpoch() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return epoch;
+}
+
+bool ReplicationLog::truncateThrough(uint64_t checkpointLsn)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!file.is_open()) return false;
+    file.flush();
+
+    std::ifstream in(path, std::ios::binary);
+    std::string contents = formatHeader(epoch, checkpointLsn);
+    std::string line;
+    while (std::getline(in, line)) {
+        auto record = parseRecord(line);
+        if (record && record->lsn > checkpointLsn) {
+            contents += line + "\n";
+        }
+    }
+    in.close();
+
+    if (!replaceFile(path, contents)) return false;
+    file.close();
+    file.open(path, std::ios::app | std::ios::binary);
+    return file.is_open();
+}
+
+LogReader::LogReader(std::string logPath) : path(std::move(logPath)) {}
+
+LogReader::~LogReader()
+{
+    if (fd >= 0) ::close(fd);
+}
+
+std::optional<LogHeader> LogReader::open()
+{
+    if (fd >= 0) ::close(fd);
+    partial.clear();
+    fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) return std::nullopt;
+    // El inodo del descriptor abierto (no el de la ruta) detecta el reemplazo
+    struct stat info;
+    if (::fstat(fd, &info) != 0) return std::nullopt;
+    inode = info.st_ino;
+
+    std::string header;
+    char c;
+    while (::read(fd, &c, 1) == 1 && c != '\n') {
+        header += c;
+    }
+    return parseHeader(header);
+}
+
+std::vector<LogRecord> LogReader::poll(bool& replaced)
+{
+    std::vector<LogRecord> records;
+    replaced = false;
+    if (fd < 0) return records;
+
+    char buffer[65536];
+    ssize_t bytesRead;
+    size_t total = 0;
+    while ((bytesRead = ::read(fd, buffer, sizeof(buffer))) > 0) {
+        partial.append(buffer, bytesRead);
+        total += bytesRead;
+    }
+
+    size_t pos = 0, end;
+    while ((end = partial.find('\n', pos)) != std::string::npos) {
+        if (auto record = parseRecord(partial.substr(pos, end - pos))) {
+            records.push_back(std::move(*record));
+        }
+        pos = end + 1;
+    }
+    partial.erase(0, pos);
+
+    // Sin datos nuevos: si el primario publicó otro log, el actual ya no crecerá
+    struct stat info;
+    replaced = total == 0 && ::stat(path.c_str(), &info) == 0 && info.st_ino != inode;
+    return records;
+}
@@ -0,0 +1,124 @@
+#include "MiniDB/ResultCache.hpp"
+#include <iterator>
+
+// Memoria aproximada de una entrada: textos más nodos de la lista y del mapa
+static size_t entryBytes(const std::string& key, const std::string& result)
+{
+    return 2 * key.size() + result.size() + 128;
+}
+
+void ResultCache::setCapacity(size_t newCapacity)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    capacity = newCapacity;
+    evictIfNeeded();
+}
+
+bool ResultCache::isEnabled() const
+{
+    return capacity > 0;
+}
+
+std::optional<std::string> ResultCache::lookup(const std::string& key, uint64_t tableVersion)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = entries.find(key);
+    if (it == entries.end()) {
+        counters.misses++;
+        return std::nullopt;
+    }
+    if (it->second->version != tableVersion) {
+        erase(it->second);
+        counters.invalidations++;
+        counters.misses++;
+        return std::nullopt;
+    }
+    lru.splice(lru.begin(), lru, it->second);
+    counters.hits++;
+    return lru.front().result;
+}
+
+void ResultCache::insert(const std::string& key, uint64_t tableVersion, std::string result)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    if (entryBytes(key, result) > capacity) return; // No cabe ni con la caché vacía
+
+    auto it = entries.find(key);
+    if (it != entries.end()) {
+        erase(it->second);
+    }
+    bytes += entryBytes(key, result);
+    lru.push_front({key, tableVersion, std::move(result)});
+    entries[key] = lru.begin();
+    evictIfNeeded();
+}
+
+void ResultCache::clear()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    lru.clear();
+    entries.clear();
+    bytes = 0;
+}
+
+ResultCacheStats ResultCache::getStats() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    ResultCacheStats stats = counters;
+    stats.capacity = capacity;
+    stats.bytes = bytes;
+    stats.entries = entries.size();
+    return stats;
+}
+
+void ResultCache::erase(std::list<Entry>::iterator it)
+{
+    bytes -= entryBytes(it->key, it->result);
+    entries.erase(it->key);
+    lru.erase(it);
+}
+
+void ResultCache::evictIfNeeded()
+{
+    while (bytes > capacity && !lru.empty()) {
+        erase(std::prev(lru.end()));
+        counters.evictions++;
+    }
+}
+
+// Serializa el árbol WHERE con paréntesis explícitos
+static void appendExpr(std::string& out, const WhereExpr& expr)
+{
+    switch (expr.type) {
+        case ExprType::PREDICATE:
+            out += expr.predicate.column + " " + expr.predicate.op + " " + expr.predicate.value;
+            break;
+        case ExprType::NOT:
+            out += "NOT (";
+            appendExpr(out, expr.children.front());
+            out += ")";
+            break;
+        case ExprType::AND:
+        case ExprType::OR:
+            for (size_t i = 0; i < expr.children.size(); ++i) {
+                if (i > 0) out += expr.type == ExprType::AND ? " AND " : " OR ";
+                out += "(";
+                appendExpr(out, expr.children[i]);
+                out += ")";
+            }
+            break;
+    }
+}
+
+std::string resultCacheKey(const Command& command)
+{
+    std::string key = command.tableName + "|";
+    for (const auto& column : command.columnNames) {
+        key += column + ",";
+    }
+    key += "|";
+    if (command.whereClause) {
+        appendExpr(key, *command.whereClause);
+    }
+    return key;
+}
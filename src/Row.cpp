@@ -0,0 +1,165 @@
+#include "MiniDB/Row.hpp"
+#include <algorithm>
+#include <cctype>
+#include <iomanip>
+#include <limits>
+#include <sstream>
+
+std::string typeName(DataType type)
+{
+    switch (type) {
+        case DataType::INTEGER: return "INTEGER";
+        case DataType::TEXT: return "TEXT";
+        case DataType::BIGINT: return "BIGINT";
+        case DataType::SMALLINT: return "SMALLINT";
+        case DataType::DOUBLE: return "DOUBLE";
+        case DataType::BOOLEAN: return "BOOLEAN";
+    }
+    return "TEXT";
+}
+
+std::optional<DataType> parseType(const std::string& name)
+{
+    for (auto type : {DataType::INTEGER, DataType::TEXT, DataType::BIGINT,
+                      DataType::SMALLINT, DataType::DOUBLE, DataType::BOOLEAN}) {
+        if (typeName(type) == name) return type;
+    }
+    return std::nullopt;
+}
+
+bool isIntegral(DataType type)
+{
+    return type == DataType::SMALLINT || type == DataType::INTEGER || type == DataType::BIGINT;
+}
+
+bool isNumeric(DataType type)
+{
+    return isIntegral(type) || type == DataType::DOUBLE;
+}
+
+static std::string upper(std::string text)
+{
+    std::transform(text.begin(), text.end(), text.begin(), [](unsigned char c) { return std::toupper(c); });
+    return text;
+}
+
+bool isNullLiteral(const std::string& text)
+{
+    return upper(text) == "NULL";
+}
+
+// El número debe ocupar todo el literal ("12abc" no es válido); solo se
+// admiten espacios al final, como los que deja "VALUES (1 , 2)"
+static bool consumedAll(const std::string& text, size_t pos)
+{
+    return text.find_first_not_of(" \t", pos) == std::string::npos;
+}
+
+std::optional<CellValue> parseCell(const std::string& text, DataType type)
+{
+    try {
+        switch (type) {
+            case DataType::TEXT:
+                return CellValue(text);
+            case DataType::SMALLINT:
+            case DataType::INTEGER:
+            case DataType::BIGINT: {
+                size_t pos = 0;
+                long long value = std::stoll(text, &pos);
+                if (!consumedAll(text, pos)) break;
+                if (type == DataType::SMALLINT) {
+                    if (value < std::numeric_limits<int16_t>::min() || value > std::numeric_limits<int16_t>::max()) break;
+                    return CellValue(static_cast<int16_t>(value));
+                }
+                if (type == DataType::INTEGER) {
+                    if (value < std::numeric_limits<int>::min() || value > std::numeric_limits<int>::max()) break;
+                    return CellValue(static_cast<int>(value));
+                }
+                return CellValue(static_cast<int64_t>(value));
+            }
+            case DataType::DOUBLE: {
+                size_t pos = 0;
+                double value = std::stod(text, &pos);
+                if (!consumedAll(text, pos)) break;
+                return CellValue(value);
+            }
+            case DataType::BOOLEAN: {
+                std::string word = upper(text);
+                if (word == "TRUE" || word == "1") return CellValue(true);
+                if (word == "FALSE" || word == "0") return CellValue(false);
+                break;
+            }
+        }
+    } catch (const std::exception& e) {
+        // Literal inválido o fuera de rango
+    }
+    return std::nullopt;
+}
+
+std::optional<CellValue> coerceCell(const CellValue& value, DataType type)
+{
+    switch (type) {
+        case DataType::SMALLINT:
+        case DataType::INTEGER:
+        case DataType::BIGINT: {
+            auto number = integralValue(value);
+            if (auto real = std::get_if<double>(&value)) {
+                // ±2^63 son exactos en double; NaN no cumple ninguna comparación
+                if (!(*real >= -9223372036854775808.0 && *real < 9223372036854775808.0)) return std::nullopt;
+                number = static_cast<int64_t>(*real);
+            }
+            if (!number) return std::nullopt;
+            if (type == DataType::SMALLINT) {
+                if (*number < std::numeric_limits<int16_t>::min() || *number > std::numeric_limits<int16_t>::max()) break;
+                return CellValue(static_cast<int16_t>(*number));
+            }
+            if (type == DataType::INTEGER) {
+                if (*number < std::numeric_limits<int>::min() || *number > std::numeric_limits<int>::max()) break;
+                return CellValue(static_cast<int>(*number));
+            }
+            return CellValue(*number);
+        }
+        case DataType::DOUBLE:
+            if (auto number = numericValue(value)) return CellValue(*number);
+            break;
+        case DataType::BOOLEAN:
+            if (std::holds_alternative<bool>(value)) return value;
+            break;
+        case DataType::TEXT:
+            if (std::holds_alternative<std::string>(value)) return value;
+            break;
+    }
+    return std::nullopt;
+}
+
+std::optional<int64_t> integralValue(const CellValue& value)
+{
+    if (auto v = std::get_if<int>(&value)) return *v;
+    if (auto v = std::get_if<int64_t>(&value)) return *v;
+    if (auto v = std::get_if<int16_t>(&value)) return *v;
+    return std::nullopt;
+}
+
+std::optional<double> numericValue(const CellValue& value)
+{
+    if (auto v = std::get_if<double>(&value)) return *v;
+    if (auto v = integralValue(value)) return static_cast<double>(*v);
+    return std::nullopt;
+}
+
+std::string formatCell(const CellValue& value)
+{
+    if (auto v = std::get_if<std::string>(&value)) return *v;
+    if (auto v = std::get_if<bool>(&value)) return *v ? "TRUE" : "FALSE";
+    if (auto v = std::get_if<double>(&value)) {
+        // La representación más corta que vuelve a leerse como el mismo valor
+        std::ostringstream oss;
+        oss << std::setprecision(15) << *v;
+        if (std::stod(oss.str()) != *v) {
+            oss.str("");
+            oss << std::setprecision(17) << *v;
+        }
+        return oss.str();
+    }
+    return std::to_string(*integralValue(value));
+}
@@ -0,0 +1,116 @@
+#include "MiniDB/Scheduler.hpp"
+
+Scheduler::Scheduler(size_t workerCount, size_t maxQueuedTasks)
+    : maxQueued(maxQueuedTasks)
+{
+    for (size_t i = 0; i < workerCount; ++i) {
+        workers.emplace_back(&Scheduler::workerLoop, this);
+    }
+}
+
+Scheduler::~Scheduler()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    workAvailable.notify_all();
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+void Scheduler::enqueue(const std::string& table, AccessMode mode, Job job, Job then)
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    spaceAvailable.wait(lock, [this] { return queue.size() < maxQueued; });
+    queue.push_back({table, mode, std::move(job), std::move(then)});
+    lock.unlock();
+    workAvailable.notify_one();
+}
+
+bool Scheduler::canRun(size_t position) const
+{
+    const Task& task = queue[position];
+    if (exclusiveRunning) return false;
+    if (task.mode == AccessMode::EXCLUSIVE) {
+        return running == 0 && position == 0;
+    }
+
+    // No adelantarse a una tarea anterior con la que entra en conflicto
+    for (size_t i = 0; i < position; ++i) {
+        const Task& earlier = queue[i];
+        if (earlier.mode == AccessMode::EXCLUSIVE) return false;
+        if (earlier.table == task.table && (earlier.mode == AccessMode::WRITE || task.mode == AccessMode::WRITE)) {
+            return false;
+        }
+    }
+
+    if (runningWriters.count(task.table)) return false;
+    if (task.mode == AccessMode::WRITE) {
+        auto it = runningReaders.find(task.table);
+        return it == runningReaders.end() || it->second == 0;
+    }
+    return true;
+}
+
+void Scheduler::markRunning(const Task& task, bool isRunning)
+{
+    if (isRunning) {
+        running++;
+    } else {
+        running--;
+    }
+    switch (task.mode) {
+        case AccessMode::EXCLUSIVE:
+            exclusiveRunning = isRunning;
+            break;
+        case AccessMode::WRITE:
+            if (isRunning) {
+                runningWriters.insert(task.table);
+            } else {
+                runningWriters.erase(task.table);
+            }
+            break;
+        case AccessMode::READ:
+            if (isRunning) {
+                runningReaders[task.table]++;
+            } else if (--runningReaders[task.table] == 0) {
+                runningReaders.erase(task.table);
+            }
+            break;
+    }
+}
+
+void Scheduler::workerLoop()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        size_t position = 0;
+        workAvailable.wait(lock, [&] {
+            for (position = 0; position < queue.size(); ++position) {
+                if (canRun(position)) return true;
+            }
+            return stopping && queue.empty();
+        });
+        if (position == queue.size()) return; // Se detiene con la cola vacía
+
+        Task task = std::move(queue[position]);
+        queue.erase(queue.begin() + position);
+        markRunning(task, true);
+        lock.unlock();
+        spaceAvailable.notify_one();
+
+        task.job();
+
+        lock.lock();
+        markRunning(task, false);
+        // Al terminar pueden quedar libres varias tareas bloqueadas
+        workAvailable.notify_all();
+        if (task.then) {
+            lock.unlock();
+            task.then();
+            lock.lock();
+        }
+    }
+}
@@ -0,0 +1,165 @@
+#include "MiniDB/Statistics.hpp"
+#include "MiniDB/Table.hpp"
+#include <algorithm>
+#include <cmath>
+
+// Número de cubetas del histograma equi-depth
+constexpr size_t HISTOGRAM_BUCKETS = 32;
+
+// Selectividades por defecto cuando no hay estadísticas
+constexpr double DEFAULT_EQUALITY_SELECTIVITY = 0.1;
+constexpr double DEFAULT_RANGE_SELECTIVITY = 0.33;
+
+// Mezcla de bits (splitmix64) para repartir bien los hashes entre registros
+static uint64_t mixHash(uint64_t x)
+{
+    x += 0x9e3779b97f4a7c15ULL;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+    return x ^ (x >> 31);
+}
+
+static uint64_t hashCell(const CellValue& value)
+{
+    if (auto number = integralValue(value)) {
+        return mixHash(static_cast<uint64_t>(*number));
+    }
+    if (auto real = std::get_if<double>(&value)) {
+        return mixHash(std::hash<double>{}(*real));
+    }
+    if (auto flag = std::get_if<bool>(&value)) {
+        return mixHash(*flag);
+    }
+    return mixHash(std::hash<std::string>{}(std::get<std::string>(value)));
+}
+
+HyperLogLog::HyperLogLog(int p) : precision(p), registers(size_t(1) << p, 0) {}
+
+void HyperLogLog::add(uint64_t hash)
+{
+    size_t index = hash >> (64 - precision);
+    uint64_t rest = hash << precision;
+    // Posición del primer bit en 1 de los bits restantes
+    uint8_t rank = 1;
+    while (rank <= 64 - precision && (rest & (1ULL << 63)) == 0) {
+        rest <<= 1;
+        rank++;
+    }
+    registers[index] = std::max(registers[index], rank);
+}
+
+double HyperLogLog::estimate() const
+{
+    double m = static_cast<double>(registers.size());
+    double sum = 0.0;
+    size_t zeros = 0;
+    for (uint8_t r : registers) {
+        sum += std::ldexp(1.0, -r);
+        if (r == 0) zeros++;
+    }
+    double alpha = 0.7213 / (1.0 + 1.079 / m);
+    double estimate = alpha * m * m / sum;
+    // Corrección para cardinalidades pequeñas (linear counting)
+    if (estimate <= 2.5 * m && zeros > 0) {
+        estimate = m * std::log(m / zeros);
+    }
+    return estimate;
+}
+
+TableStats analyzeTable(const Table& table)
+{
+    TableStats stats;
+    stats.analyzed = true;
+    stats.rowCount = table.getRowCount();
+
+    // Un solo recorrido acumula las estadísticas de todas las columnas
+    const auto& columns = table.getColumns();
+    std::vector<ColumnStats> colStats(columns.size());
+    std::vector<HyperLogLog> hlls(columns.size());
+    std::vector<std::vector<int64_t>> values(columns.size());
+
+    table.scan(nullptr, nullptr, [&](const Row& row) {
+        for (size_t c = 0; c < columns.size(); ++c) {
+            auto it = row.find(columns[c].name);
+            if (it == row.end()) {
+                colStats[c].nullCount++;
+                continue;
+            }
+            hlls[c].add(hashCell(it->second));
+            if (!isIntegral(columns[c].type)) continue;
+            if (auto number = integralValue(it->second)) values[c].push_back(*number);
+        }
+    });
+
+    for (size_t c = 0; c < columns.size(); ++c) {
+        // El estimador no puede superar el número de valores no nulos
+        colStats[c].distinct = std::min(hlls[c].estimate(),
+                                        static_cast<double>(stats.rowCount - colStats[c].nullCount));
+
+        // Histograma equi-depth: cada cubeta contiene aproximadamente las mismas filas
+        auto& sorted = values[c];
+        if (!sorted.empty()) {
+            std::sort(sorted.begin(), sorted.end());
+            size_t buckets = std::min(HISTOGRAM_BUCKETS, sorted.size());
+            for (size_t i = 0; i < buckets; ++i) {
+                colStats[c].histogram.push_back(sorted[i * sorted.size() / buckets]);
+            }
+            colStats[c].histogram.push_back(sorted.back());
+        }
+        stats.columns[columns[c].name] = std::move(colStats[c]);
+    }
+    return stats;
+}
+
+// Fracción de valores no nulos menores que 'value' según el histograma
+static double fractionBelow(const std::vector<int64_t>& bounds, int64_t value)
+{
+    if (value <= bounds.front()) return 0.0;
+    if (value > bounds.back()) return 1.0;
+
+    size_t buckets = bounds.size() - 1;
+    auto upper = std::upper_bound(bounds.begin(), bounds.end(), value);
+    size_t i = std::distance(bounds.begin(), upper) - 1;
+    if (i >= buckets) return 1.0;
+
+    double width = static_cast<double>(bounds[i + 1]) - bounds[i];
+    double within = width > 0 ? (static_cast<double>(value) - bounds[i]) / width : 0.0;
+    return (i + within) / buckets;
+}
+
+static double nonNullFraction(const ColumnStats& stats, size_t rowCount)
+{
+    if (rowCount == 0) return 1.0;
+    return 1.0 - std::min(1.0, static_cast<double>(stats.nullCount) / rowCount);
+}
+
+double estimateEquality(const ColumnStats* stats, size_t rowCount, std::optional<int64_t> value)
+{
+    if (!stats || stats->distinct < 1.0) {
+        return DEFAULT_EQUALITY_SELECTIVITY;
+    }
+    const auto& bounds = stats->histogram;
+    if (value && !bounds.empty() && (*value < bounds.front() || *value > bounds.back())) {
+        return 0.0;
+    }
+    return nonNullFraction(*stats, rowCount) / stats->distinct;
+}
+
+double estimateRange(const ColumnStats* stats, size_t rowCount,
+                     std::optional<int64_t> low, bool lowInclusive,
+                     std::optional<int64_t> high, bool highInclusive)
+{
+    if (!stats || stats->histogram.size() < 2) {
+        double selectivity = 1.0;
+        if (low) selectivity *= DEFAULT_RANGE_SELECTIVITY;
+        if (high) selectivity *= DEFAULT_RANGE_SELECTIVITY;
+        return selectivity;
+    }
+
+    const auto& bounds = stats->histogram;
+    double equal = estimateEquality(stats, rowCount, std::nullopt) / nonNullFraction(*stats, rowCount);
+    double from = low ? fractionBelow(bounds, *low) + (lowInclusive ? 0.0 : equal) : 0.0;
+    double to = high ? fractionBelow(bounds, *high) + (highInclusive ? equal : 0.0) : 1.0;
+    double fraction = std::clamp(to - from, 0.0, 1.0);
+    return fraction * nonNullFraction(*stats, rowCount);
+}
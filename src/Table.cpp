@@ -1,40 +1,554 @@
 #include "MiniDB/Table.hpp"
 #include <algorithm>
 
-Table::Table(std::vector<Column> cols) : columns(std::move(cols)) {}
+// Bloques que se piden por adelantado al buffer pool durante un recorrido secuencial
+constexpr size_t READ_AHEAD_BLOCKS = 4;
+
+Table::Table(std::vector<Column> cols, std::shared_ptr<BufferPool> bufferPool)
+    : columns(std::move(cols)), pool(std::move(bufferPool)) {}
+
+Table::~Table()
+{
+    for (const auto& block : blocks) {
+        pool->free(block.page);
+    }
+}
 
 bool Table::insert(const Row& row)
 {
-    rows.push_back(row);
+    if (blocks.empty() || blocks.back().rowCount >= BLOCK_SIZE) {
+        RowBlock block;
+        block.page = pool->allocate(ColumnPage(columns));
+        blocks.push_back(std::move(block));
+    }
+    auto& block = blocks.back();
+    PageHandle page = pool->pin(block.page);
+    auto& data = page.page();
+    data.append(row);
+    page.markDirty();
+    block.rowCount++;
+    extendZones(block, data, block.rowCount - 1);
+    version++;
+
+    // Los índices vigentes se pueden extender sin reconstruirlos
+    RowId id{blocks.size() - 1, block.rowCount - 1};
+    for (size_t c = 0; c < columns.size(); ++c) {
+        auto indexIt = indexes.find(columns[c].name);
+        if (indexIt == indexes.end() || indexIt->second.stale) continue;
+        if (auto value = data.column(c).get(id.slot)) {
+            indexIt->second.entries[*value].push_back(id);
+        }
+    }
     return true;
 }
 
-int Table::deleteRows(std::function<bool(const Row&)> condition)
+int Table::deleteRows(const RowSelector& selector, const BlockFilter& blockFilter, const CandidateMap* candidates)
 {
-    auto original_size = rows.size();
-    auto it = std::remove_if(rows.begin(), rows.end(), condition);
-    rows.erase(it, rows.end());
-    return original_size - rows.size();
+    int deleted_count = 0;
+    std::vector<size_t> selection;
+    for (size_t b = 0; b < blocks.size(); ++b) {
+        auto& block = blocks[b];
+        if (blockFilter && !blockFilter(block)) {
+            rowsSkipped += block.rowCount;
+            continue;
+        }
+        if (!prepareSelection(b, candidates, selection)) continue;
+
+        // Solo hace falta leer la página para evaluar la condición
+        if (selector) {
+            prefetchAfter(b, blockFilter, candidates);
+            PageHandle page = pool->pin(block.page);
+            selector(page.page(), selection);
+        }
+
+        // Marcar tombstones: la página no se modifica ni se mueve ninguna fila
+        for (size_t i : selection) {
+            block.markDeleted(i);
+        }
+        deleted_count += selection.size();
+    }
+    if (deleted_count > 0) {
+        version++;
+    }
+    return deleted_count;
 }
 
-int Table::updateRows(std::function<bool(const Row&)> condition, std::function<void(Row&)> updateAction)
+int Table::updateRows(const RowSelector& selector, const RowBatchUpdate& updateAction,
+                      const std::vector<std::string>& changedColumns,
+                      const BlockFilter& blockFilter, const CandidateMap* candidates)
 {
+    // Índices vigentes afectados por la sentencia (posición de su columna en la página)
+    std::vector<std::pair<size_t, Index*>> touched;
+    for (size_t c = 0; c < columns.size(); ++c) {
+        auto indexIt = indexes.find(columns[c].name);
+        if (indexIt == indexes.end() || indexIt->second.stale) continue;
+        if (std::find(changedColumns.begin(), changedColumns.end(), columns[c].name) != changedColumns.end()) {
+            touched.emplace_back(c, &indexIt->second);
+        }
+    }
+
     int updated_count = 0;
-    for (auto& row : rows) {
-        if (condition(row)) {
-            updateAction(row);
-            updated_count++;
+    std::vector<size_t> selection;
+    std::vector<std::vector<std::optional<CellValue>>> before(touched.size());
+    for (size_t b = 0; b < blocks.size(); ++b) {
+        auto& block = blocks[b];
+        if (blockFilter && !blockFilter(block)) {
+            rowsSkipped += block.rowCount;
+            continue;
+        }
+        if (!prepareSelection(b, candidates, selection)) continue;
+
+        prefetchAfter(b, blockFilter, candidates);
+        PageHandle page = pool->pin(block.page);
+        auto& data = page.page();
+        if (selector) selector(data, selection);
+        if (!selection.empty()) {
+            for (size_t t = 0; t < touched.size(); ++t) {
+                const auto& values = data.column(touched[t].first);
+                before[t].clear();
+                for (size_t i : selection) before[t].push_back(values.get(i));
+            }
+            updateAction(data, selection);
+            page.markDirty();
+            updated_count += selection.size();
+            recomputeZones(block, data);
+
+            // Solo las filas cuyo valor cambió se mueven de clave en el índice
+            for (size_t t = 0; t < touched.size(); ++t) {
+                const auto& values = data.column(touched[t].first);
+                for (size_t k = 0; k < selection.size(); ++k) {
+                    auto after = values.get(selection[k]);
+                    if (after != before[t][k]) {
+                        moveIndexEntry(touched[t].second->entries, before[t][k], after, RowId{b, selection[k]});
+                    }
+                }
+            }
         }
     }
+    if (updated_count > 0) {
+        version++;
+    }
     return updated_count;
 }
 
-const std::vector<Row>& Table::getRows() const
+void Table::scan(const BlockFilter& blockFilter, const RowSelector& selector,
+                 const std::function<void(const Row&)>& visitor, const CandidateMap* candidates) const
+{
+    std::vector<size_t> selection;
+    for (size_t b = 0; b < blocks.size(); ++b) {
+        const auto& block = blocks[b];
+        if (blockFilter && !blockFilter(block)) {
+            rowsSkipped += block.rowCount;
+            continue;
+        }
+        if (!prepareSelection(b, candidates, selection)) continue;
+
+        prefetchAfter(b, blockFilter, candidates);
+        PageHandle page = pool->pin(block.page);
+        const auto& data = page.page();
+        if (selector) selector(data, selection);
+        for (size_t i : selection) {
+            visitor(data.row(i));
+        }
+    }
+}
+
+// Prepara el vector de selección de un bloque sin las filas borradas.
+// Devuelve false si no queda ninguna fila candidata en el bloque.
+bool Table::prepareSelection(size_t blockIndex, const CandidateMap* candidates, std::vector<size_t>& selection) const
+{
+    const auto& block = blocks[blockIndex];
+    if (block.deletedCount == block.rowCount) return false; // Todas las filas están borradas
+
+    selection.clear();
+    if (candidates) {
+        auto it = candidates->find(blockIndex);
+        if (it == candidates->end()) return false;
+        for (size_t i : it->second) {
+            if (!block.isDeleted(i)) selection.push_back(i);
+        }
+    } else {
+        for (size_t i = 0; i < block.rowCount; ++i) {
+            if (!block.isDeleted(i)) selection.push_back(i);
+        }
+    }
+    return !selection.empty();
+}
+
+// Read-ahead: pide al buffer pool los próximos bloques que el recorrido va a leer
+void Table::prefetchAfter(size_t blockIndex, const BlockFilter& blockFilter, const CandidateMap* candidates) const
+{
+    size_t requested = 0;
+    for (size_t b = blockIndex + 1; b < blocks.size() && requested < READ_AHEAD_BLOCKS; ++b) {
+        if (blocks[b].deletedCount == blocks[b].rowCount) continue;
+        if (blockFilter && !blockFilter(blocks[b])) continue;
+        if (candidates && candidates->find(b) == candidates->end()) continue;
+        pool->prefetch(blocks[b].page);
+        requested++;
+    }
+}
+
+bool Table::createIndex(const std::string& indexName, const std::string& column)
+{
+    auto colIt = std::find_if(columns.begin(), columns.end(),
+                              [&](const Column& c) { return c.name == column; });
+    if (colIt == columns.end() || indexes.find(column) != indexes.end()) {
+        return false; // Columna inexistente o ya indexada
+    }
+    indexes[column].name = indexName;
+    return true;
+}
+
+bool Table::hasIndex(const std::string& column) const
+{
+    return indexes.find(column) != indexes.end();
+}
+
+std::string Table::getIndexName(const std::string& column) const
+{
+    auto it = indexes.find(column);
+    return it != indexes.end() ? it->second.name : "";
+}
+
+std::vector<std::string> Table::getIndexedColumns() const
+{
+    std::vector<std::string> result;
+    for (const auto& pair : indexes) {
+        result.push_back(pair.first);
+    }
+    return result;
+}
+
+CandidateMap Table::indexLookup(const std::string& column, const CellValue& key) const
+{
+    CandidateMap result;
+    auto indexIt = indexes.find(column);
+    if (indexIt == indexes.end()) return result;
+
+    const auto& entries = ensureIndex(column, indexIt->second);
+    auto it = entries.find(key);
+    if (it != entries.end()) {
+        for (const auto& id : it->second) {
+            result[id.block].push_back(id.slot);
+        }
+    }
+    return result;
+}
+
+CandidateMap Table::indexRange(const std::string& column, std::optional<int64_t> low, bool lowInclusive,
+                               std::optional<int64_t> high, bool highInclusive) const
+{
+    CandidateMap result;
+    auto indexIt = indexes.find(column);
+    if (indexIt == indexes.end()) return result;
+
+    const auto& entries = ensureIndex(column, indexIt->second);
+    auto it = entries.begin();
+    if (low) {
+        // Las claves tienen el ancho de la columna; un límite que no cabe en
+        // ella queda por debajo (se recorre desde el principio) o por encima
+        auto colIt = std::find_if(columns.begin(), columns.end(),
+                                  [&](const Column& c) { return c.name == column; });
+        if (auto key = coerceCell(CellValue(*low), colIt->type)) {
+            it = entries.lower_bound(*key);
+        } else if (*low > 0) {
+            return result;
+        }
+    }
+    for (; it != entries.end(); ++it) {
+        auto value = integralValue(it->first);
+        if (!value) break;
+        if (low && !lowInclusive && *value == *low) continue;
+        if (high && (*value > *high || (!highInclusive && *value == *high))) break;
+        for (const auto& id : it->second) {
+            result[id.block].push_back(id.slot);
+        }
+    }
+    for (auto& pair : result) {
+        std::sort(pair.second.begin(), pair.second.end());
+    }
+    return result;
+}
+
+const RowIndex& Table::ensureIndex(const std::string& column, const Index& index) const
+{
+    std::lock_guard<std::mutex> lock(indexMutex);
+    if (index.stale) {
+        index.entries.clear();
+        auto colIt = std::find_if(columns.begin(), columns.end(),
+                                  [&](const Column& c) { return c.name == column; });
+        size_t c = colIt - columns.begin();
+        for (size_t b = 0; b < blocks.size(); ++b) {
+            PageHandle page = pool->pin(blocks[b].page);
+            const auto& values = page.page().column(c);
+            for (size_t i = 0; i < blocks[b].rowCount; ++i) {
+                if (blocks[b].isDeleted(i)) continue;
+                if (auto value = values.get(i)) {
+                    index.entries[*value].push_back({b, i});
+                }
+            }
+        }
+        index.stale = false;
+    }
+    return index.entries;
+}
+
+// Mueve la fila 'id' de la clave 'before' a la clave 'after' (nullopt = NULL,
+// que no está en el índice). Las filas de cada clave siguen ordenadas.
+void Table::moveIndexEntry(RowIndex& entries, const std::optional<CellValue>& before,
+                           const std::optional<CellValue>& after, RowId id)
 {
-    return rows;
+    auto less = [](const RowId& a, const RowId& b) {
+        return a.block != b.block ? a.block < b.block : a.slot < b.slot;
+    };
+    if (before) {
+        auto it = entries.find(*before);
+        if (it != entries.end()) {
+            auto& ids = it->second;
+            auto pos = std::lower_bound(ids.begin(), ids.end(), id, less);
+            if (pos != ids.end() && pos->block == id.block && pos->slot == id.slot) ids.erase(pos);
+            if (ids.empty()) entries.erase(it);
+        }
+    }
+    if (after) {
+        auto& ids = entries[*after];
+        ids.insert(std::lower_bound(ids.begin(), ids.end(), id, less), id);
+    }
+}
+
+void Table::invalidateIndexes()
+{
+    for (auto& pair : indexes) {
+        pair.second.stale = true;
+        pair.second.entries.clear();
+    }
+}
+
+void Table::setStats(TableStats newStats)
+{
+    stats = std::move(newStats);
+}
+
+const TableStats& Table::getStats() const
+{
+    return stats;
+}
+
+void Table::appendBlock(std::vector<Row> blockRows, std::unordered_map<std::string, ZoneMap> zones)
+{
+    if (blockRows.empty()) return;
+
+    ColumnPage data(columns);
+    for (const auto& row : blockRows) {
+        data.append(row);
+    }
+
+    RowBlock block;
+    block.rowCount = blockRows.size();
+    block.zones = std::move(zones);
+
+    bool complete = true;
+    for (const auto& col : columns) {
+        if (isIntegral(col.type) && block.zones.find(col.name) == block.zones.end()) {
+            complete = false;
+        }
+    }
+    if (!complete) {
+        recomputeZones(block, data);
+    }
+
+    block.page = pool->allocate(std::move(data));
+    blocks.push_back(std::move(block));
+    version++;
+    invalidateIndexes();
+}
+
+void Table::appendBlocks(Table& source)
+{
+    if (source.blocks.empty()) return;
+    for (auto& block : source.blocks) {
+        blocks.push_back(std::move(block));
+    }
+    source.blocks.clear(); // Las páginas ya son de esta tabla
+    version++;
+    invalidateIndexes();
+}
+
+std::optional<size_t> Table::findCompactionCandidate(double deadRatio) const
+{
+    for (size_t b = 0; b < blocks.size(); ++b) {
+        const auto& block = blocks[b];
+        if (block.deletedCount > 0 && block.deletedCount >= deadRatio * block.rowCount) {
+            return b;
+        }
+    }
+    return std::nullopt;
+}
+
+void Table::compactBlock(size_t blockIndex)
+{
+    auto& block = blocks[blockIndex];
+    if (block.deletedCount == block.rowCount) {
+        pool->free(block.page);
+        blocks.erase(blocks.begin() + blockIndex);
+        // Los índices vigentes pierden las filas del bloque y los bloques
+        // siguientes bajan una posición (el orden de los RowId se conserva)
+        for (auto& pair : indexes) {
+            if (pair.second.stale) continue;
+            auto& entries = pair.second.entries;
+            for (auto it = entries.begin(); it != entries.end();) {
+                auto& ids = it->second;
+                ids.erase(std::remove_if(ids.begin(), ids.end(),
+                                         [&](const RowId& id) { return id.block == blockIndex; }),
+                          ids.end());
+                for (auto& id : ids) {
+                    if (id.block > blockIndex) id.block--;
+                }
+                it = ids.empty() ? entries.erase(it) : std::next(it);
+            }
+        }
+    } else {
+        PageHandle page = pool->pin(block.page);
+        auto& data = page.page();
+        std::vector<size_t> keep;
+        for (size_t i = 0; i < data.size(); ++i) {
+            if (!block.isDeleted(i)) keep.push_back(i);
+        }
+        // Los índices vigentes se corrigen con los valores aún sin mover: las
+        // filas borradas salen y las demás pasan a su nueva posición
+        for (auto& pair : indexes) {
+            if (pair.second.stale) continue;
+            auto colIt = std::find_if(columns.begin(), columns.end(),
+                                      [&](const Column& c) { return c.name == pair.first; });
+            const auto& values = data.column(colIt - columns.begin());
+            size_t next = 0;
+            for (size_t i = 0; i < data.size(); ++i) {
+                bool kept = next < keep.size() && keep[next] == i;
+                size_t slot = kept ? next++ : 0;
+                if (kept && slot == i) continue;
+                auto value = values.get(i);
+                if (!value) continue;
+                moveIndexEntry(pair.second.entries, value, std::nullopt, {blockIndex, i});
+                if (kept) moveIndexEntry(pair.second.entries, std::nullopt, value, {blockIndex, slot});
+            }
+        }
+        data.retain(keep);
+        page.markDirty();
+        block.rowCount = keep.size();
+        block.deleted.clear();
+        block.deletedCount = 0;
+        recomputeZones(block, data);
+    }
+    compactedBlocks++;
+}
+
+void Table::forEachBlock(const std::function<void(const RowBlock&, const ColumnPage&)>& visitor) const
+{
+    for (size_t b = 0; b < blocks.size(); ++b) {
+        prefetchAfter(b, nullptr, nullptr);
+        PageHandle page = pool->pin(blocks[b].page);
+        visitor(blocks[b], page.page());
+    }
+}
+
+// Min/max de un arreglo de enteros recorrido de corrido, saltando los NULL
+template <typename T>
+static ZoneMap computeZone(const std::vector<T>& values, const ColumnVector& column, size_t rows)
+{
+    ZoneMap zone;
+    for (size_t i = 0; i < rows; ++i) {
+        if (!column.isValid(i)) {
+            zone.nullCount++;
+            continue;
+        }
+        int64_t value = values[i];
+        if (!zone.hasValues) {
+            zone.min = zone.max = value;
+            zone.hasValues = true;
+        } else {
+            zone.min = std::min(zone.min, value);
+            zone.max = std::max(zone.max, value);
+        }
+    }
+    return zone;
+}
+
+void Table::recomputeZones(RowBlock& block, const ColumnPage& page) const
+{
+    block.zones.clear();
+    for (size_t c = 0; c < columns.size(); ++c) {
+        const auto& column = page.column(c);
+        if (column.type == DataType::SMALLINT) {
+            block.zones[column.name] = computeZone(column.smallints, column, page.size());
+        } else if (column.type == DataType::INTEGER) {
+            block.zones[column.name] = computeZone(column.ints, column, page.size());
+        } else if (column.type == DataType::BIGINT) {
+            block.zones[column.name] = computeZone(column.bigints, column, page.size());
+        }
+    }
+}
+
+void Table::extendZones(RowBlock& block, const ColumnPage& page, size_t slot) const
+{
+    for (size_t c = 0; c < columns.size(); ++c) {
+        if (!isIntegral(columns[c].type)) continue;
+
+        auto& zone = block.zones[columns[c].name];
+        auto cell = page.column(c).get(slot);
+        if (!cell) {
+            zone.nullCount++;
+            continue;
+        }
+        int64_t value = *integralValue(*cell);
+        if (!zone.hasValues) {
+            zone.min = zone.max = value;
+            zone.hasValues = true;
+        } else {
+            zone.min = std::min(zone.min, value);
+            zone.max = std::max(zone.max, value);
+        }
+    }
+}
+
+const std::vector<RowBlock>& Table::getBlocks() const
+{
+    return blocks;
 }
 
 const std::vector<Column>& Table::getColumns() const
 {
     return columns;
-}
\ No newline at end of file
+}
+
+size_t Table::getRowCount() const
+{
+    size_t count = 0;
+    for (const auto& block : blocks) {
+        count += block.rowCount - block.deletedCount;
+    }
+    return count;
+}
+
+size_t Table::getDeletedRowCount() const
+{
+    size_t count = 0;
+    for (const auto& block : blocks) {
+        count += block.deletedCount;
+    }
+    return count;
+}
+
+size_t Table::getCompactedBlocks() const
+{
+    return compactedBlocks;
+}
+
+size_t Table::getRowsSkipped() const
+{
+    return rowsSkipped;
+}
+
+uint64_t Table::getVersion() const
+{
+    return version;
+}
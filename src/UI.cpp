@@ -3,8 +3,46 @@
 #include <fstream>
 #include <sstream>
 #include <vector>
+#include <cstdlib>
 
-UI::UI() : db("minidb.db") {}
+// Presupuesto del buffer pool: variable de entorno MINIDB_BUFFER_POOL_MB o el valor por defecto
+static size_t bufferPoolBudget()
+{
+    const char* env = std::getenv("MINIDB_BUFFER_POOL_MB");
+    if (env) {
+        try {
+            return std::stoul(env) * 1024 * 1024;
+        } catch (const std::exception& e) {
+            std::cout << "Aviso: MINIDB_BUFFER_POOL_MB no es válido, se usa el valor por defecto.\n";
+        }
+    }
+    return DEFAULT_BUFFER_POOL_BYTES;
+}
+
+// MINIDB_PREFETCH_TABLES=1 carga las tablas en segundo plano al iniciar
+static bool prefetchTables()
+{
+    const char* env = std::getenv("MINIDB_PREFETCH_TABLES");
+    return env && std::string(env) == "1";
+}
+
+// MINIDB_FOLLOW=<ruta del minidb.db del primario> arranca una réplica de solo
+// lectura que aplica su log; MINIDB_REPLICATION=primary hace que esta base de
+// datos escriba ese log ('minidb.db.log')
+static const char* followPath()
+{
+    const char* env = std::getenv("MINIDB_FOLLOW");
+    return env && *env ? env : nullptr;
+}
+
+static ReplicationRole replicationRole()
+{
+    if (followPath()) return ReplicationRole::FOLLOWER;
+    const char* env = std::getenv("MINIDB_REPLICATION");
+    return env && std::string(env) == "primary" ? ReplicationRole::PRIMARY : ReplicationRole::NONE;
+}
+
+UI::UI() : db(followPath() ? followPath() : "minidb.db", bufferPoolBudget(), prefetchTables(), replicationRole()) {}
 
 void UI::displayMenu()
 {
@@ -24,7 +62,7 @@ void UI::handleCreateTable()
     std::string tableName, column_str;
     std::cout << "Nombre de la tabla: ";
     std::getline(std::cin, tableName); // "usuarios"
-    std::cout << "Columnas (ej: id INTEGER, nombre TEXT): ";
+    std::cout << "Columnas (ej: id INTEGER, nombre TEXT, precio DOUBLE): ";
     std::getline(std::cin, column_str);
     
     // Construir una consulta SQL y dejar que el parser y el ejecutor hagan el trabajo
@@ -92,12 +130,29 @@ void UI::executeQuery(const std::string& query) {
 }
 
 void UI::handleHelp() {
-    std::cout << "MiniDB es una base de datos simple que guarda los datos en 'minidb.db'.\n";
+    std::cout << "MiniDB es una base de datos simple que guarda su catálogo en 'minidb.db' y las filas en 'minidb.db.d/'.\n";
     std::cout << "Puedes usar el modo guiado o ejecutar consultas SQL directamente.\n";
     std::cout << "Ejemplos de SQL: \n";
     std::cout << "  CREATE TABLE usuarios (id,nombre);\n";
     std::cout << "  INSERT INTO usuarios VALUES (1,Juan);\n";
     std::cout << "  SELECT * FROM usuarios;\n";
+    std::cout << "  UPDATE usuarios SET nombre = Ana, id = id + 10 WHERE id = 1;\n";
+    std::cout << "  SELECT * FROM usuarios WHERE id > 1 AND NOT (nombre = Juan OR id = 5);\n";
+    std::cout << "  CREATE TABLE medidas (id BIGINT, sensor SMALLINT, valor DOUBLE, activo BOOLEAN);\n";
+    std::cout << "  INSERT INTO medidas VALUES (1,3,21.5,TRUE);\n";
+    std::cout << "  INSERT INTO medidas VALUES (2,3,NULL,FALSE);\n";
+    std::cout << "  SELECT * FROM medidas WHERE valor IS NULL OR valor > 20.5;\n";
+    std::cout << "  CREATE TABLE ventas (id INTEGER, total INTEGER) PARTITION BY HASH(id) PARTITIONS 4;\n";
+    std::cout << "  CREATE TABLE pedidos (anio INTEGER, total INTEGER) PARTITION BY RANGE(anio) VALUES (2020, 2024);\n";
+    std::cout << "  CREATE INDEX idx_id ON usuarios (id);\n";
+    std::cout << "  ANALYZE usuarios;\n";
+    std::cout << "  EXPLAIN SELECT * FROM usuarios WHERE id = 1;\n";
+    std::cout << "  SHOW STATS;\n";
+    std::cout << "  SET buffer_pool_mb = 64;\n";
+    std::cout << "  SET checkpoint_interval_s = 30;\n";
+    std::cout << "  SET compaction_threshold = 0.25;\n";
+    std::cout << "  SET result_cache_mb = 16;\n";
+    std::cout << "  CHECKPOINT;\n";
 }
 
 void UI::run()